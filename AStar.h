@@ -7,6 +7,7 @@
 #include "Map.h"
 #include "lux\kit.hpp"
 #include "Bot.h"
+#include "TileOccupancy.h"
 
 enum Category { CLOSED = 0, OPEN, UNVISITED };
 
@@ -34,7 +35,7 @@ struct AStarExplorationEntry {
   double fScore;
 };
 
-inline std::vector<tileindex_t> aStar(const Map &map, const Bot &start, tileindex_t goalIndex, const std::vector<tileindex_t> &agentsPosition, pathflags_t pathFlags)
+inline std::vector<tileindex_t> aStar(const Map &map, const Bot &start, tileindex_t goalIndex, const TileOccupancy &occupancy, pathflags_t pathFlags)
 {
 	AStarNode currentRecord;
 	std::vector<AStarNode> nodeRecords(map.getMapSize());
@@ -66,7 +67,7 @@ inline std::vector<tileindex_t> aStar(const Map &map, const Bot &start, tileinde
 
 			if (tentativeG <= 25.0f 
 			  && map.tileAt(neighbourIndex).getType() != TileType::ALLY_CITY 
-			  && std::ranges::find(agentsPosition, neighbourIndex) != agentsPosition.end())
+			  && occupancy.isOccupied(neighbourIndex))
 				continue;
 
 			AStarNode &neighbourRecord = nodeRecords[neighbourIndex];
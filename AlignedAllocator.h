@@ -0,0 +1,27 @@
+#ifndef ALIGNED_ALLOCATOR_H
+#define ALIGNED_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+
+// std::allocator that aligns its storage to 'Alignment' bytes, used for SIMD friendly buffers
+template <class T, size_t Alignment>
+struct AlignedAllocator
+{
+  using value_type = T;
+
+  template <class U>
+  struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+  AlignedAllocator() = default;
+  template <class U>
+  constexpr AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+  T *allocate(size_t n) { return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t{ Alignment })); }
+  void deallocate(T *ptr, size_t n) noexcept { ::operator delete(ptr, n * sizeof(T), std::align_val_t{ Alignment }); }
+
+  template <class U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept { return true; }
+};
+
+#endif
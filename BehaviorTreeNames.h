@@ -19,8 +19,6 @@ DEF_BLACKBOARD_ENTRY(GLOBAL_FRIENDLY_CITY_COUNT); // int
 DEF_BLACKBOARD_ENTRY(GLOBAL_CITY_COUNT); // int
 DEF_BLACKBOARD_ENTRY(GLOBAL_TEAM_RESEARCH_POINT); // size_t
 DEF_BLACKBOARD_ENTRY(GLOBAL_GAME_STATE); // GameState*
-DEF_BLACKBOARD_ENTRY(GLOBAL_AGENTS_POSITION); //std::vector<tileindex_t>*
-DEF_BLACKBOARD_ENTRY(GLOBAL_NONCITY_POSITION); //std::vector<tileindex_t>*
 
 
 // agent-scope entries
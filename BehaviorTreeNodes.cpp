@@ -3,6 +3,7 @@
 #include "Benchmarking.h"
 #include "Pathing.h"
 #include "CommandChain.h"
+#include "UnitId.h"
 #include "lux/annotate.hpp"
 
 namespace nodes
@@ -55,7 +56,7 @@ std::shared_ptr<Task> testHasTeamEnoughResearchPoint()
 
 static void botLog(const Bot *bot, auto &&...args) {
   std::stringstream ss;
-  ss << bot->getId() << "[" << bot->getX() << " " << bot->getY() << "] ";
+  ss << unit_id::toString(bot->getId()) << "[" << bot->getX() << " " << bot->getY() << "] ";
   (ss << ... << args);
   lux::Annotate::sidetext(ss.str());
 }
@@ -118,12 +119,10 @@ std::shared_ptr<Task> taskMoveTo(
       }),
       taskPlayAgentTurn([](Blackboard &bb) {
         auto &path = bb.getData<std::vector<tileindex_t>>(bbn::AGENT_PATHFINDING_PATH);
-        auto &occupiedTiles = bb.getData<std::vector<tileindex_t>*>(bbn::GLOBAL_AGENTS_POSITION);
-        auto &map = bb.getData<Map*>(bbn::GLOBAL_MAP);
+        GameState *gameState = bb.getData<GameState *>(bbn::GLOBAL_GAME_STATE);
         const Bot *bot = bb.getData<Bot *>(bbn::AGENT_SELF);
         tileindex_t nextTile = path.back();
-        occupiedTiles->push_back(nextTile);
-        occupiedTiles->erase(std::ranges::find(*occupiedTiles, map->getTileIndex(*bot)));
+        gameState->occupancy.moveUnit(gameState->map.getTileIndex(*bot), nextTile);
         return TurnOrder{ TurnOrder::MOVE, bot, nextTile };
       })
     );
@@ -131,17 +130,16 @@ std::shared_ptr<Task> taskMoveTo(
   auto computePathTask = 
     std::make_shared<ComplexAction>([pathFlags](Blackboard &bb) {
       const Bot *bot = bb.getData<Bot*>(bbn::AGENT_SELF);
-      const Map *map = bb.getData<Map*>(bbn::GLOBAL_MAP);
+      const GameState *gameState = bb.getData<GameState *>(bbn::GLOBAL_GAME_STATE);
       tileindex_t goalIndex = bb.getData<tileindex_t>(bbn::AGENT_PATHFINDING_GOAL);
-      auto occupiedTiles = bb.getData<std::vector<tileindex_t>*>(bbn::GLOBAL_AGENTS_POSITION);
 
       MULTIBENCHMARK_LAPBEGIN(Astar);
-      std::vector<tileindex_t> path = aStar(*map, *bot, goalIndex, *occupiedTiles, pathFlags(bb));
+      std::vector<tileindex_t> path = aStar(gameState->map, *bot, goalIndex, gameState->occupancy, pathFlags(bb));
       MULTIBENCHMARK_LAPEND(Astar);
 
       if (path.empty()) {
         // FUTURE relax constraints and find another path
-        //LOG(bot->getId() << ": could not find a valid path to its target tile " << map->getTilePosition(goalIndex) << " from " << bot->getX() << "," << bot->getY());
+        //LOG(unit_id::toString(bot->getId()) << ": could not find a valid path to its target tile " << map->getTilePosition(goalIndex) << " from " << bot->getX() << "," << bot->getY());
         return TaskResult::FAILURE; // probably due to the goal not being valid/reachable
       }
       path.pop_back();
@@ -160,7 +158,7 @@ std::shared_ptr<Task> taskMoveTo(
       const Map *map = bb.getData<Map *>(bbn::GLOBAL_MAP);
       tileindex_t target = goalFinder(bb);
       if (!map->isValidTileIndex(target)) {
-        LOG(bot->getId() << ": could not find a valid target tile for " << bb.getData<std::string>(bbn::AGENT_PATHFINDING_TYPE));
+        LOG(unit_id::toString(bot->getId()) << ": could not find a valid target tile for " << bb.getData<std::string>(bbn::AGENT_PATHFINDING_TYPE));
         return TaskResult::PENDING;
       }
       bb.insertData(bbn::AGENT_PATHFINDING_GOAL, target);
@@ -172,9 +170,8 @@ std::shared_ptr<Task> taskMoveTo(
       if(!bb.hasData(bbn::AGENT_PATHFINDING_PATH)) return false;
       const GameState *gameState = bb.getData<GameState*>(bbn::GLOBAL_GAME_STATE);
       const std::vector<tileindex_t> &path = bb.getData<std::vector<tileindex_t>>(bbn::AGENT_PATHFINDING_PATH);
-      const std::vector<tileindex_t> &botPositions = *bb.getData<std::vector<tileindex_t>*>(bbn::GLOBAL_AGENTS_POSITION);
       constexpr size_t minimumValidTilesAhead = 3;
-      return pathing::checkPathValidity(path, gameState->map, botPositions, minimumValidTilesAhead);
+      return pathing::checkPathValidity(path, gameState->map, gameState->occupancy, minimumValidTilesAhead);
     });
 
   auto clearPathcacheTask =
@@ -392,8 +389,7 @@ std::shared_ptr<Task> taskMoveToBestTileAtNight() {
   GoalSupplier goalSupplier = [](Blackboard &bb) -> tileindex_t {
     const Bot *bot = bb.getData<Bot *>(bbn::AGENT_SELF);
     const GameState *gameState = bb.getData<GameState *>(bbn::GLOBAL_GAME_STATE);
-    const std::vector<tileindex_t> *occupiedTiles = bb.getData<std::vector<tileindex_t>*>(bbn::GLOBAL_NONCITY_POSITION);
-    return pathing::getBestNightTimeLocation(gameState->map.getTileIndex(bot->getX(), bot->getY()), gameState, *occupiedTiles);
+    return pathing::getBestNightTimeLocation(gameState->map.getTileIndex(bot->getX(), bot->getY()), gameState);
   };
 
   PathFlagsSupplier flagsSupplier = [](Blackboard &bb) -> pathflags_t {
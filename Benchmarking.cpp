@@ -1,8 +1,63 @@
 #include "Benchmarking.h"
 
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
 #ifdef BENCHMARKING
 
 std::stringstream benchmark::logs;
+long long benchmark::allocationCount = 0;
+
+// count every allocation made through the global operator new
+void *operator new(size_t size)
+{
+  ++benchmark::allocationCount;
+  if (void *ptr = std::malloc(size != 0 ? size : 1))
+    return ptr;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+// over-aligned allocations (see AlignedAllocator.h) are counted too
+void *operator new(size_t size, std::align_val_t alignment)
+{
+  ++benchmark::allocationCount;
+  size_t align = static_cast<size_t>(alignment);
+  size = size != 0 ? (size + align - 1) / align * align : align;
+#ifdef _WIN32
+  if (void *ptr = _aligned_malloc(size, align))
+#else
+  if (void *ptr = std::aligned_alloc(align, size))
+#endif
+    return ptr;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+#ifdef _WIN32
+  _aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+
+void operator delete(void *ptr, size_t, std::align_val_t alignment) noexcept
+{
+  operator delete(ptr, alignment);
+}
 
 // not ideal... but will do
 #undef MULTIBENCHMARK_DEFINE
@@ -13,5 +68,6 @@ MULTIBENCHMARK_DEFINE(AgentBT);
 MULTIBENCHMARK_DEFINE(getBestCityBuildingLocation);
 MULTIBENCHMARK_DEFINE(getBestCityFeedingLocation);
 MULTIBENCHMARK_DEFINE(propagateAllTimes);
+MULTIBENCHMARK_DEFINE(unitScans);
 
 #endif
\ No newline at end of file
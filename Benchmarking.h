@@ -1,6 +1,7 @@
 #ifndef BENCHMARKING_H
 #define BENCHMARKING_H
 
+#include <algorithm>
 #include <sstream>
 #include <chrono>
 
@@ -10,6 +11,9 @@
 #define BENCHMARK_DURATION(name) (std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - __##name##_t0).count()/1e6)
 #define BENCHMARK_BEGIN(name) auto __##name##_t0 = std::chrono::high_resolution_clock::now()
 #define BENCHMARK_END(name) benchmark::logs << std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - __##name##_t0).count()/1e6 << "ms for " #name << "\n"
+#define BENCHMARK_END_AVERAGE(name, n, unit) benchmark::logs << std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - __##name##_t0).count()/(double)std::max<size_t>(n, 1) << "ns per " unit " for " #name << "\n"
+#define ALLOCBENCHMARK_BEGIN(name) auto __##name##_a0 = benchmark::allocationCount
+#define ALLOCBENCHMARK_END(name) benchmark::logs << (benchmark::allocationCount - __##name##_a0) << " allocations for " #name << "\n"
 #define MULTIBENCHMARK_DEFINE(name) extern long long __##name##_total, __##name##_count
 #define MULTIBENCHMARK_BEGIN(name) benchmark::__##name##_total = 0; benchmark::__##name##_count = 0
 #define MULTIBENCHMARK_LAPBEGIN(name) auto __##name##_lapt0 = std::chrono::high_resolution_clock::now()
@@ -18,6 +22,9 @@
 #else
 #define BENCHMARK_BEGIN(name)
 #define BENCHMARK_END(name)
+#define BENCHMARK_END_AVERAGE(name, n, unit)
+#define ALLOCBENCHMARK_BEGIN(name)
+#define ALLOCBENCHMARK_END(name)
 #define MULTIBENCHMARK_DEFINE(name)
 #define MULTIBENCHMARK_BEGIN(name)
 #define MULTIBENCHMARK_LAPBEGIN(name)
@@ -30,12 +37,15 @@ namespace benchmark
 {
 
 extern std::stringstream logs;
+// number of heap allocations since the program started, see ALLOCBENCHMARK_*
+extern long long allocationCount;
 
 MULTIBENCHMARK_DEFINE(Astar);
 MULTIBENCHMARK_DEFINE(AgentBT);
 MULTIBENCHMARK_DEFINE(getBestCityBuildingLocation);
 MULTIBENCHMARK_DEFINE(getBestCityFeedingLocation);
 MULTIBENCHMARK_DEFINE(propagateAllTimes);
+MULTIBENCHMARK_DEFINE(unitScans);
 
 }
 #endif
@@ -1,45 +1,32 @@
 #ifndef BOT_H
 #define BOT_H
 
-#include <string>
-
 #include "Types.h"
 #include "BehaviorTree.h"
 #include "Benchmarking.h"
+#include "UnitStore.h"
 
-enum class UnitType {
-  WORKER = 0,
-  CART,
-  CITY
-};
-
+// cold part of a unit, the fields read every turn are kept by the UnitStore
 class Bot
 {
 public:
-  Bot(const std::string &id, UnitType type, player_t team, const std::shared_ptr<BasicBehavior> &behaviorTree)
-    : m_id(id)
-    , m_type(type)
-    , m_team(team)
+  Bot(UnitStore &store, unithandle_t handle, const std::shared_ptr<BasicBehavior> &behaviorTree)
+    : m_store(&store)
+    , m_handle(handle)
     , m_blackboard(std::make_shared<Blackboard>())
     , m_behaviorTree(behaviorTree)
   {}
 
-  const std::string &getId() const { return m_id; }
-  int getX() const { return m_x; }
-  int getY() const { return m_y; }
-  player_t getTeam() const { return m_team; }
-  UnitType getType() const { return m_type; }
-  float getCooldown() const { return m_cooldown; }
-  int getWoodAmount() const { return m_wood; }
-  int getCoalAmount() const { return m_coal; }
-  int getUraniumAmount() const { return m_uranium; }
-
-  void setX(int x) { m_x = x; }
-  void setY(int y) { m_y = y; }
-  void setCooldown(float cooldown) { m_cooldown = cooldown; }
-  void setWoodAmount(int wood) { m_wood = wood; }
-  void setCoalAmount(int coal) { m_coal = coal; }
-  void setUraniumAmount(int uranium) { m_uranium = uranium; }
+  unithandle_t getHandle() const { return m_handle; }
+  unitid_t getId() const { return m_store->getId(m_handle); }
+  int getX() const { return m_store->getX(m_handle); }
+  int getY() const { return m_store->getY(m_handle); }
+  player_t getTeam() const { return m_store->getTeam(m_handle); }
+  UnitType getType() const { return m_store->getType(m_handle); }
+  float getCooldown() const { return m_store->getCooldown(m_handle); }
+  int getWoodAmount() const { return m_store->getWoodAmount(m_handle); }
+  int getCoalAmount() const { return m_store->getCoalAmount(m_handle); }
+  int getUraniumAmount() const { return m_store->getUraniumAmount(m_handle); }
 
   void reserve(UnitType unit) { isReserved = true; unitToCreate = unit; }
   void acted() { hasCreated = true; }
@@ -62,12 +49,8 @@ public:
   Bot &operator=(Bot &&) = delete;
 
 private:
-  std::string m_id;
-  int         m_x{}, m_y{};
-  float       m_cooldown{};
-  int         m_wood{}, m_coal{}, m_uranium{};
-  UnitType   m_type;
-  player_t    m_team;
+  UnitStore   *m_store;
+  unithandle_t m_handle;
   std::shared_ptr<Blackboard>    m_blackboard;
   std::shared_ptr<BasicBehavior> m_behaviorTree;
   // city only, helps optimization on unit creation
@@ -32,43 +32,34 @@ void Commander::updateHighLevelObjectives(GameState *state, const GameStateDiff
 
 void Commander::updateBlackBoard()
 {
-    static size_t turnNumber = 0;
-
-    turnNumber++;
-
     int nbAgents = 0;
     int nbWorkers = 0;
     int nbCarts = 0;
     int nbCities = 0;
 
-    m_blackboardKeepAlive.agentsPositions.clear();
-    m_blackboardKeepAlive.nonCityPositions.clear();
-    std::ranges::transform(m_gameState->bots, std::back_inserter(m_blackboardKeepAlive.agentsPositions),
-      [this](const auto &bot) { return m_gameState->map.getTileIndex(*bot); });
-    std::ranges::for_each(m_gameState->bots,
-      [&](const auto &bot) { if (bot->getType() != UnitType::CITY) m_blackboardKeepAlive.nonCityPositions.push_back(m_gameState->map.getTileIndex(*bot)); });
-
-    for (auto &bot : m_gameState->bots) {
-        if (bot->getTeam() != Player::ALLY) continue;
-        if (bot->getType() == UnitType::CITY) {
+    const UnitStore &store = *m_gameState->unitStore;
+    MULTIBENCHMARK_LAPBEGIN(unitScans);
+    for (unithandle_t unit : m_gameState->units) {
+        if (store.getTeam(unit) != Player::ALLY) continue;
+        UnitType type = store.getType(unit);
+        if (type == UnitType::CITY) {
             nbCities++;
         }
-        if (bot->getType() == UnitType::WORKER) {
+        if (type == UnitType::WORKER) {
             nbAgents++;
             nbWorkers++;
         }
-        if (bot->getType() == UnitType::CART) {
+        if (type == UnitType::CART) {
             nbCities++;
             nbCarts++;
         }
     }
+    MULTIBENCHMARK_LAPEND(unitScans);
 
-    m_globalBlackboard->insertData(bbn::GLOBAL_TURN, turnNumber);
+    m_globalBlackboard->insertData(bbn::GLOBAL_TURN, m_gameState->currentTurn);
     m_globalBlackboard->insertData(bbn::GLOBAL_GAME_STATE, m_gameState);
     m_globalBlackboard->insertData(bbn::GLOBAL_MAP, &m_gameState->map);
     m_globalBlackboard->insertData(bbn::GLOBAL_TEAM_RESEARCH_POINT, m_gameState->playerResearchPoints[Player::ALLY]);
-    m_globalBlackboard->insertData(bbn::GLOBAL_AGENTS_POSITION, &m_blackboardKeepAlive.agentsPositions);
-    m_globalBlackboard->insertData(bbn::GLOBAL_NONCITY_POSITION, &m_blackboardKeepAlive.nonCityPositions);
     m_globalBlackboard->insertData(bbn::GLOBAL_AGENTS, nbAgents);
     m_globalBlackboard->insertData(bbn::GLOBAL_WORKERS, nbWorkers);
     m_globalBlackboard->insertData(bbn::GLOBAL_CARTS, nbCarts);
@@ -86,13 +77,16 @@ std::vector<TurnOrder> Commander::getTurnOrders(const GameStateDiff &diff)
 
     int availableUnits = m_globalBlackboard->getData<int>(bbn::GLOBAL_FRIENDLY_CITY_COUNT) * 2 - m_globalBlackboard->getData<int>(bbn::GLOBAL_AGENTS);
 
-    for (auto &city : m_gameState->bots) {
-        if (city->getType() == UnitType::CITY && city->getTeam() == Player::ALLY) {
-            friendlyCities.emplace_back(city.get());
-            if (city->getCooldown() < game_rules::MAX_ACT_COOLDOWN)
-                availableCities.emplace_back(city.get());
+    const UnitStore &store = *m_gameState->unitStore;
+    MULTIBENCHMARK_LAPBEGIN(unitScans);
+    for (unithandle_t unit : m_gameState->units) {
+        if (store.getType(unit) == UnitType::CITY && store.getTeam(unit) == Player::ALLY) {
+            friendlyCities.emplace_back(store.getBot(unit));
+            if (store.getCooldown(unit) < game_rules::MAX_ACT_COOLDOWN)
+                availableCities.emplace_back(store.getBot(unit));
         }
     }
+    MULTIBENCHMARK_LAPEND(unitScans);
 
     //For each squad...
     std::ranges::for_each(m_squads, [&diff,&friendlyCities,&availableUnits](Squad &squad) {
@@ -263,24 +257,28 @@ std::array<std::vector<CityCluster>, Player::COUNT> Strategy::getCityClusters(co
     constexpr float maxClusterRadius = 5.f;
     std::array<std::vector<RawCityCluster>, Player::COUNT> clusters;
 
-    for(const std::unique_ptr<Bot> &bot : gameState.bots) {
-      if (bot->getType() != UnitType::CITY)
+    const UnitStore &store = *gameState.unitStore;
+    MULTIBENCHMARK_LAPBEGIN(unitScans);
+    for(unithandle_t unit : gameState.units) {
+      if (store.getType(unit) != UnitType::CITY)
         continue;
-      const Bot &cityTile = *bot;
-      auto &botFriendlyClusters = clusters[cityTile.getTeam()];
+      float cityX = (float)store.getX(unit);
+      float cityY = (float)store.getY(unit);
+      auto &botFriendlyClusters = clusters[store.getTeam(unit)];
 
-      auto distanceToCluster = [&](RawCityCluster cluster) { return std::abs(cluster.centerX - (float)cityTile.getX()) + std::abs(cluster.centerY - (float)cityTile.getY()); };
+      auto distanceToCluster = [&](RawCityCluster cluster) { return std::abs(cluster.centerX - cityX) + std::abs(cluster.centerY - cityY); };
       auto nearestCluster = std::ranges::min_element(botFriendlyClusters, std::less{}, distanceToCluster);
 
       if(nearestCluster == botFriendlyClusters.end() || distanceToCluster(*nearestCluster) > maxClusterRadius) {
-        botFriendlyClusters.emplace_back((float)cityTile.getX(), (float)cityTile.getY(), 1);
+        botFriendlyClusters.emplace_back(cityX, cityY, 1);
       } else {
         auto &c = *nearestCluster;
-        c.centerX = (c.centerX * (float)c.cityTileCount + (float)cityTile.getX()) / ((float)c.cityTileCount + 1);
-        c.centerY = (c.centerY * (float)c.cityTileCount + (float)cityTile.getY()) / ((float)c.cityTileCount + 1);
+        c.centerX = (c.centerX * (float)c.cityTileCount + cityX) / ((float)c.cityTileCount + 1);
+        c.centerY = (c.centerY * (float)c.cityTileCount + cityY) / ((float)c.cityTileCount + 1);
         c.cityTileCount++;
       }
     }
+    MULTIBENCHMARK_LAPEND(unitScans);
 
     std::array<std::vector<CityCluster>, Player::COUNT> finalClusters;
     for(size_t i = 0; i < Player::COUNT; i++) {
@@ -327,18 +325,49 @@ std::vector<EnemySquadInfo> Strategy::getEnemyStance(const GameState &gameState)
       std::erase_if(enemyClusters, [](auto &cluster) { return cluster.cityTileCount < 3; });
     }
 
-    InfluenceMap propagatedInfluence = gameState.resourcesInfluence.propagateAllTimes(1);
+    // paths only cover a few tiles, coverage is checked on the sets of tiles they cover
+    TileSet resourceTiles = gameState.resourcesInfluence.propagateAllTimes(1).getPositiveTiles();
+    std::vector<TileSet> enemyClusterTiles;
+    for (const CityCluster &cluster : cityClusters[Player::ENEMY]) {
+      InfluenceMap ccMap{ gameState.citiesInfluence.getWidth(), gameState.citiesInfluence.getHeight() };
+      ccMap.addTemplateAtIndex(ccMap.getIndex(cluster.center_x, cluster.center_y), influence_templates::ENEMY_CITY_CLUSTER_PROXIMITY);
+      enemyClusterTiles.push_back(ccMap.getPositiveTiles());
+    }
+
+    std::unordered_set<unitid_t> seenIds;
 
-    std::unordered_set<std::string> seenIds;
+    const UnitStore &store = *gameState.unitStore;
 
-    std::unordered_map<std::string, InfluenceMap> propagatedPaths;
-    for(auto &[botId, path] : gameState.ennemyPath) {
-      auto propagated = path.propagateAllTimes(params::propagationRadius);
-      propagated.normalize();
-      propagatedPaths.emplace(botId, std::move(propagated));
+    // the paths of the visible enemies are built from their trajectories, then propagated
+    // (blurred) to make them more sensitive to surroundings
+    std::vector<std::pair<unitid_t, const EnemyTrajectory *>> trajectories;
+    for (unithandle_t unit : gameState.units) {
+      auto trajectory = gameState.ennemyTrajectories.find(store.getBot(unit)->getId());
+      if (trajectory != gameState.ennemyTrajectories.end())
+        trajectories.emplace_back(trajectory->first, &trajectory->second);
+    }
+    m_paths.resize(trajectories.size());
+    m_propagatedPaths.resize(trajectories.size());
+    std::vector<const InfluenceMap *> pathSources;
+    std::unordered_map<unitid_t, size_t> pathIndices;
+    for (size_t i = 0; i < trajectories.size(); i++) {
+      auto [botId, trajectory] = trajectories[i];
+      m_paths[i].setSize(gameState.map.getWidth(), gameState.map.getHeight());
+      trajectory->addPath(m_paths[i], params::ennemyPathingTurn);
+      pathSources.push_back(&m_paths[i]);
+      pathIndices.emplace(botId, i);
     }
+    m_diffusion.propagate(pathSources, params::propagationRadius, m_propagatedPaths);
+    m_propagatedPathTiles.clear();
+    for (InfluenceMap &propagatedPath : m_propagatedPaths) {
+      propagatedPath.normalize();
+      m_propagatedPathTiles.push_back(propagatedPath.getPositiveTiles());
+    }
+    // every path is blurred a second time before being compared, in one batch
+    m_similarities.reset(m_propagatedPaths, params::propagationRadius, params::similarityTolerance);
 
-    for(const std::unique_ptr<Bot> &bot : gameState.bots) {
+    for(unithandle_t unit : gameState.units) {
+      const Bot *bot = store.getBot(unit);
       // We don't look at enemies nor cities
       if (bot->getType() == UnitType::CITY || bot->getTeam() != Player::ENEMY)
         continue;
@@ -347,30 +376,31 @@ std::vector<EnemySquadInfo> Strategy::getEnemyStance(const GameState &gameState)
       if (seenIds.contains(bot->getId()))
         continue;
 
+      size_t pathIndex = pathIndices.at(bot->getId());
       EnemySquadInfo enemySquadInfo{
         bot->getType() == UnitType::WORKER ? (unsigned int)1 : (unsigned int)0,
         bot->getType() == UnitType::CART ? (unsigned int)1 : (unsigned int)0,
-        gameState.ennemyPath.at(bot->getId()), // FIX
+        m_paths[pathIndex], // FIX
         Archetype::CITIZEN
       };
 
-      // propagate the path (blur) to make it more sensitive to surroundings
-      InfluenceMap &propagatedPath = propagatedPaths[bot->getId()];
+      const TileSet &propagatedPathTiles = m_propagatedPathTiles[pathIndex];
 
       // compare with not already assigned bots
-      for(const std::unique_ptr<Bot> &bot2 : gameState.bots)
+      for(unithandle_t unit2 : gameState.units)
       {
+          const Bot *bot2 = store.getBot(unit2);
           // We don't look at enemies nor cities
           if (bot->getType() == UnitType::CITY || bot->getTeam() != Player::ENEMY)
               continue;
           // We don't look at already assigned bots
           if (seenIds.contains(bot->getId()))
               continue;
-          if (!gameState.ennemyPath.contains(bot2->getId())) continue;
+          auto path2 = pathIndices.find(bot2->getId());
+          if (path2 == pathIndices.end()) continue;
           if (bot->getId() == bot2->getId()) continue;
-          auto &path2 = propagatedPaths[bot2->getId()];
           // We check if paths are similar
-          if (propagatedPath.propagateAllTimes(params::propagationRadius).getSimilarity(path2, params::similarityTolerance) >= params::similarPercentage) {
+          if (m_similarities.get(pathIndex, path2->second) >= params::similarPercentage) {
             seenIds.insert(bot2->getId());
             if (bot->getType() == UnitType::WORKER)
                 enemySquadInfo.botNb++;
@@ -382,23 +412,17 @@ std::vector<EnemySquadInfo> Strategy::getEnemyStance(const GameState &gameState)
       // guess the squad's current objective
 
       // if bot's path covers a resource point...
-      if (propagatedPath.coversTiles(propagatedInfluence, params::resourceTilesNeeded))
+      if (propagatedPathTiles.coversTiles(resourceTiles, params::resourceTilesNeeded))
       {
           // enemyCities is an InfluenceMap created to facilitate operations with path
           InfluenceMap enemyCities{gameState.citiesInfluence.getWidth(), gameState.citiesInfluence.getHeight()};
-          bool coversACity = false;
-          for (size_t i = 0; i < cityClusters[Player::ENEMY].size(); i++){
-              InfluenceMap ccMap{ gameState.citiesInfluence.getWidth(), gameState.citiesInfluence.getHeight() };
-              ccMap.addTemplateAtIndex(ccMap.getIndex(cityClusters[Player::ENEMY][i].center_x, cityClusters[Player::ENEMY][i].center_y), influence_templates::ENEMY_CITY_CLUSTER_PROXIMITY);
-              if (propagatedPath.coversTiles(ccMap, params::cityTilesNeeded)) {
-                  coversACity = true;
-                  break;
-              }
-          }
+          bool coversACity = std::ranges::any_of(enemyClusterTiles, [&](const TileSet &clusterTiles) {
+              return propagatedPathTiles.coversTiles(clusterTiles, params::cityTilesNeeded);
+          });
       
           // if bot's path covers a resource point AND an enemy city, he's either expanding the city or fueling it (same movement pattern, in fact)
           if (coversACity) {
-              auto &path = gameState.ennemyPath.at(bot->getId());
+              const InfluenceMap &path = enemySquadInfo.path;
               enemySquadInfo.mission = Archetype::FARMER; // Or CITIZEN, really
               InfluenceMap startCheck{ path };
               startCheck.multiplyMap(enemyCities);
@@ -420,11 +444,13 @@ std::vector<EnemySquadInfo> Strategy::getEnemyStance(const GameState &gameState)
       {
         bool movingTowardsAllyCity = false;
         CityCluster targetedCity{};
-        // we seek if a city is targeted
+        // we seek if a city is targeted, the bot's heading over the last pathStep positions is
+        // kept up to date with its trajectory
+        constexpr float APPROACH_MIN_COSINE = 0.70710678f; // cos(PI/4)
+        const EnemyHeading &heading = trajectories[pathIndex].second->getHeading();
         for (CityCluster cc : cityClusters[0])
         {
-            // FUTURE we may wanna create a specific parameter for the length of this path
-            if (gameState.ennemyPath.at(bot->getId()).approachesPoint(cc.center_x, cc.center_y, params::ennemyPathingTurn, params::pathStep)) {
+            if (heading.approaches(cc.center_x, cc.center_y, APPROACH_MIN_COSINE)) {
                 movingTowardsAllyCity = true;
                 targetedCity = cc;
                 break;
@@ -464,11 +490,14 @@ std::pair<int,std::vector<SquadRequirement>> Strategy::adaptToEnemy(const std::v
 
     size_t availableBots = 0;
     size_t availableCarts = 0;
-    std::ranges::for_each(gameState.bots, [&availableBots, &availableCarts](const std::unique_ptr<Bot> &bot) {
-        if (bot->getTeam() != Player::ALLY) return;
-        if (bot->getType() == UnitType::CART) availableCarts++;
-        else if (bot->getType() == UnitType::WORKER) availableBots++;
+    const UnitStore &store = *gameState.unitStore;
+    MULTIBENCHMARK_LAPBEGIN(unitScans);
+    std::ranges::for_each(gameState.units, [&](unithandle_t unit) {
+        if (store.getTeam(unit) != Player::ALLY) return;
+        if (store.getType(unit) == UnitType::CART) availableCarts++;
+        else if (store.getType(unit) == UnitType::WORKER) availableBots++;
     });
+    MULTIBENCHMARK_LAPEND(unitScans);
 
     const auto &clusters = getCityClusters(gameState);
     const std::vector<CityCluster> &allyCities = clusters[Player::ALLY];
@@ -573,11 +602,14 @@ std::vector<Squad> Strategy::createSquads(const std::pair<int, std::vector<Squad
     }
 
     // collect workers/carts that can be assigned
-    for(auto &bot : gameState->bots) {
-      if (bot->getTeam() != Player::ALLY || (bot->getType() == UnitType::CITY))
+    const UnitStore &store = *gameState->unitStore;
+    MULTIBENCHMARK_LAPBEGIN(unitScans);
+    for(unithandle_t unit : gameState->units) {
+      if (store.getTeam(unit) != Player::ALLY || (store.getType(unit) == UnitType::CITY))
         continue;
-      unassignedBots.insert(bot.get());
+      unassignedBots.insert(store.getBot(unit));
     }
+    MULTIBENCHMARK_LAPEND(unitScans);
 
     for(const SquadRequirement &sr : squadRequirements) {
         //Get the sr.botNb closest bots for this SquadRequirement
@@ -5,6 +5,8 @@
 
 #include "Bot.h"
 #include "GameState.h"
+#include "InfluenceDiffusion.h"
+#include "SimilarityMatrix.h"
 #include "TurnOrder.h"
 #include "Types.h"
 
@@ -129,6 +131,12 @@ private:
 	std::array<std::vector<CityCluster>, Player::COUNT> getCityClusters(const GameState &gameState);
 	// { Nbr Citizen, Nbr Farmer } 
 	std::pair<int, int> getNbrAgent(const CityCluster &cityCluster) const;
+
+	InfluenceDiffusion m_diffusion;
+	std::vector<InfluenceMap> m_paths;
+	std::vector<InfluenceMap> m_propagatedPaths;
+	std::vector<TileSet> m_propagatedPathTiles;
+	SimilarityMatrix m_similarities;
 };
 
 class Commander
@@ -142,12 +150,6 @@ private:
 
 	Strategy currentStrategy;
 
-	// fields that are passed in the global black board by raw pointers that must be kept alive
-	struct {
-	  std::vector<tileindex_t> agentsPositions;
-	  std::vector<tileindex_t> nonCityPositions;
-	} m_blackboardKeepAlive;
-
 public:
 	Commander();
 	void updateHighLevelObjectives(GameState *state, const GameStateDiff &diff);
@@ -0,0 +1,39 @@
+#include "EnemyTrajectory.h"
+
+#include <cmath>
+
+EnemyHeading::EnemyHeading(int x, int y, int dx, int dy)
+  : m_x(static_cast<float>(x)), m_y(static_cast<float>(y))
+{
+  float length = std::sqrt(static_cast<float>(dx * dx + dy * dy));
+  if (length > 0) {
+    m_directionX = dx / length;
+    m_directionY = dy / length;
+  }
+}
+
+void EnemyTrajectory::addPath(InfluenceMap &map, int pathLength) const
+{
+  const float decay = -1.0f / pathLength;
+  float weight = 1.0f;
+  for (size_t age = 0; age < m_count; age++) {
+    map.addValueAtIndex(getSample(age).tile, weight);
+    weight += weight * decay;
+  }
+}
+
+void EnemyTrajectory::updateHeading(int mapWidth, size_t window)
+{
+  if (m_count == 0) return;
+  tileindex_t to = getSample(0).tile;
+  tileindex_t from = getSample(std::min(window, m_count - 1)).tile;
+  int x = to % mapWidth, y = to / mapWidth;
+  m_heading = EnemyHeading{ x, y, x - from % mapWidth, y - from / mapWidth };
+}
+
+InfluenceMap EnemyTrajectory::getPath(int width, int height, int pathLength) const
+{
+  InfluenceMap path{ width, height };
+  addPath(path, pathLength);
+  return path;
+}
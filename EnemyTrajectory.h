@@ -0,0 +1,80 @@
+#ifndef ENEMY_TRAJECTORY_H
+#define ENEMY_TRAJECTORY_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "GameRules.h"
+#include "InfluenceMap.h"
+#include "Types.h"
+
+// Direction an enemy unit moves in: its displacement over a window of its last positions,
+// kept as a unit vector so that checking whether the unit heads towards a point is a dot product.
+class EnemyHeading
+{
+public:
+  EnemyHeading() = default;
+  // unit at (x, y) that moved by (dx, dy) over the window
+  EnemyHeading(int x, int y, int dx, int dy);
+
+  bool isMoving() const { return m_directionX != 0 || m_directionY != 0; }
+  // true if the unit moves towards (x, y): the cosine of the angle between its direction and
+  // the direction to the point is at least 'minCosine', which must not be negative.
+  // A unit that did not move or is already on the point does not approach it.
+  bool approaches(int x, int y, float minCosine) const
+  {
+    float dx = x - m_x, dy = y - m_y;
+    float dot = m_directionX * dx + m_directionY * dy;
+    return dot > 0 && dot * dot >= minCosine * minCosine * (dx * dx + dy * dy);
+  }
+
+private:
+  float m_x = 0, m_y = 0;
+  float m_directionX = 0, m_directionY = 0;
+};
+
+// Positions of an enemy unit on the turns it was seen, in a ring of fixed size.
+// The path of the unit is the sum of its positions, each weighted by
+// (1 - 1/pathLength)^age with age the number of positions seen after it. This is the decayed
+// map that used to be updated every turn, it is now only built for the units that need it.
+// The ring holds a whole game so that no position is ever dropped.
+class EnemyTrajectory
+{
+public:
+  static constexpr size_t CAPACITY = game_rules::GAME_LENGTH;
+
+  struct Sample
+  {
+    uint16_t turn;
+    tileindex_t tile;
+  };
+
+  void add(size_t turn, tileindex_t tile)
+  {
+    m_samples[m_next] = { static_cast<uint16_t>(turn), tile };
+    m_next = (m_next + 1) % CAPACITY;
+    m_count = std::min(m_count + 1, CAPACITY);
+  }
+
+  size_t getSampleCount() const { return m_count; }
+  // 0 is the latest position
+  const Sample &getSample(size_t age) const { return m_samples[(m_next + CAPACITY - 1 - age) % CAPACITY]; }
+
+  // sets the heading to the displacement since the position seen 'window' positions before the
+  // latest one, or the oldest one, in constant time. Called after add().
+  void updateHeading(int mapWidth, size_t window);
+  const EnemyHeading &getHeading() const { return m_heading; }
+
+  // adds the path to 'map', which must have the size of the game map
+  void addPath(InfluenceMap &map, int pathLength) const;
+  InfluenceMap getPath(int width, int height, int pathLength) const;
+
+private:
+  std::array<Sample, CAPACITY> m_samples;
+  size_t m_next = 0;
+  size_t m_count = 0;
+  EnemyHeading m_heading;
+};
+
+#endif
@@ -4,6 +4,8 @@
 namespace game_rules
 {
 
+static constexpr int MAX_MAP_SIZE = 32; // maps are at most 32x32
+static constexpr size_t GAME_LENGTH = 360; // turns
 static constexpr float MAX_ACT_COOLDOWN = 1.f; // units must have cooldown<1 to act
 static constexpr size_t DAY_DURATION = 30;
 static constexpr size_t NIGHT_DURATION = 10;
@@ -1,11 +1,60 @@
 #include "GameState.h"
 #include <algorithm>
 #include "GameRules.h"
+#include "AIParams.h"
+
+void GameStateDiff::clear()
+{
+  deadBots.clear();
+  newBots.clear();
+  movedBots.clear();
+  updatedRoads.clear();
+  updatedResources.clear();
+  depletedResources.clear();
+  for (player_t team = 0; team < Player::COUNT; team++) {
+    newCityTiles[team].clear();
+    lostCityTiles[team].clear();
+    unlockedResources[team].clear();
+  }
+}
+
+void GameState::reset(int mapWidth, int mapHeight)
+{
+  currentTurn = 0;
+  map.setSize(mapWidth, mapHeight);
+  map.clear();
+  cities.clear();
+  units.clear();
+  resourcesIndex.clear();
+  citiesBot.clear();
+  playerResearchPoints[Player::ALLY] = playerResearchPoints[Player::ENEMY] = 0;
+  citiesInfluence.setSize(mapWidth, mapHeight);
+  resourcesInfluence.setSize(mapWidth, mapHeight);
+  resourceStamps.setSize(mapWidth, mapHeight);
+  allyCityTiles.setSize(mapWidth, mapHeight);
+  collectableResources.setSize(mapWidth, mapHeight);
+  ennemyPathInfluence.setSize(mapWidth, mapHeight);
+  resourcesRemaining = 0;
+}
+
+int GameState::getCollectableAmount(const Tile &tile) const
+{
+  size_t researchPoints = playerResearchPoints[Player::ALLY];
+  switch (tile.getResourceType()) {
+  case kit::ResourceType::wood:
+    return std::min((int)game_rules::COLLECT_RATE_WOOD, tile.getResourceAmount());
+  case kit::ResourceType::coal:
+    return researchPoints >= game_rules::MIN_RESEARCH_COAL ? std::min((int)game_rules::COLLECT_RATE_COAL, tile.getResourceAmount()) : 0;
+  case kit::ResourceType::uranium:
+    return researchPoints >= game_rules::MIN_RESEARCH_URANIUM ? std::min((int)game_rules::COLLECT_RATE_URANIUM, tile.getResourceAmount()) : 0;
+  }
+  return 0;
+}
 
 std::optional<const Bot*> GameState::getEntityAt(int x, int y) const
 {
-  auto it = std::ranges::find_if(bots, [=](const std::unique_ptr<Bot> &bot) { return bot->getX() == x && bot->getY() == y; });
-  return it != bots.end() ? std::optional<const Bot*>(it->get()) : std::nullopt;
+  const Bot *bot = occupancy.getFirstUnit(map.getTileIndex(x, y));
+  return bot != nullptr ? std::optional<const Bot*>(bot) : std::nullopt;
 }
 
 void GameState::computeInfluence(const GameStateDiff &gameStateDiff)
@@ -13,11 +62,17 @@ void GameState::computeInfluence(const GameStateDiff &gameStateDiff)
   std::ranges::for_each(citiesBot,
     [&](const Bot *bot) {
       tileindex_t index = map.getTileIndex(bot->getX(), bot->getY());
-      if (bot->getTeam() == Player::ALLY)
+      if (bot->getTeam() == Player::ALLY) {
         citiesInfluence.addTemplateAtIndex(index, influence_templates::CITY_ADJENCY);
+        allyCityTiles.setValueAtIndex(index, 1.f);
+      }
       citiesInfluence.setValueAtIndex(index, -100.0f);
     });
 
+  // on maps with many resource tiles, they are stamped all at once once their weights are known
+  const bool splatResources = TemplateSplat::shouldConvolve(influence_templates::RESOURCE_PROXIMITY, resourcesIndex.size(), map.getWidth(), map.getHeight());
+  if (splatResources)
+    resourceStamps.clear();
   std::ranges::for_each(resourcesIndex,
     [&](tileindex_t index) {
       float resourceScale = 0.0f;
@@ -39,10 +94,20 @@ void GameState::computeInfluence(const GameStateDiff &gameStateDiff)
       }
 
       if (resourceScale != 0) {
-        resourcesInfluence.addTemplateAtIndex(index, influence_templates::RESOURCE_PROXIMITY, resourceScale);
+        if (splatResources)
+          resourceStamps.add(index, resourceScale);
+        else
+          resourcesInfluence.addTemplateAtIndex(index, influence_templates::RESOURCE_PROXIMITY, resourceScale);
       }
+      if (tile.getType() == TileType::RESOURCE)
+        collectableResources.setValueAtIndex(index, static_cast<float>(getCollectableAmount(tile)));
       citiesInfluence.setValueAtIndex(index, -100.0f);
     });
+  if (splatResources)
+    resourceStamps.addTo(resourcesInfluence, influence_templates::RESOURCE_PROXIMITY);
+
+  for (auto &[_, trajectory] : ennemyTrajectories)
+    trajectory.addPath(ennemyPathInfluence, params::ennemyPathingTurn);
 }
 
 std::vector<bool> GameState::shouldExpand()
@@ -56,8 +121,8 @@ std::vector<bool> GameState::shouldExpand()
   size_t nightDuration = (360 - currentTurn) / 4; // 1/4 tu temps est la nuit
 
   for (int i = 0; i < cities.size(); ++i) {
-    float resourceNeeded = cities[i]->getLightUpKeep() * nightDuration;
-    if (cities[i]->getTeam() == Player::ENEMY || resourceNeeded > TOTAL_RESOURCES_PERCENT * (resourcesRemaining + cities[i]->getFuel()))
+    float resourceNeeded = cities[i].getLightUpKeep() * nightDuration;
+    if (cities[i].getTeam() == Player::ENEMY || resourceNeeded > TOTAL_RESOURCES_PERCENT * (resourcesRemaining + cities[i].getFuel()))
       citiesExpansion[i] = false;
   }
 
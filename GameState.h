@@ -1,18 +1,37 @@
 #ifndef GAME_STATE_H
 #define GAME_STATE_H
 
+#include <array>
 #include <optional>
 
 #include "Map.h"
 #include "City.h"
 #include "Bot.h"
+#include "EnemyTrajectory.h"
 #include "InfluenceMap.h"
+#include "TemplateSplat.h"
+#include "TileOccupancy.h"
 
 struct GameStateDiff
 {
-  std::vector<std::unique_ptr<Bot>> deadBots;
+  struct UnitMove
+  {
+    Bot *bot;
+    tileindex_t from, to;
+  };
+
+  std::vector<Bot *> deadBots; // released at the beginning of the next turn
   std::vector<Bot *> newBots;
+  std::vector<UnitMove> movedBots;
   std::vector<tileindex_t> updatedRoads;
+  std::vector<tileindex_t> updatedResources; // amount changed, the tile still holds resources
+  std::vector<tileindex_t> depletedResources;
+  std::array<std::vector<tileindex_t>, Player::COUNT> newCityTiles;
+  std::array<std::vector<tileindex_t>, Player::COUNT> lostCityTiles;
+  // coal/uranium became minable this turn, wood always is
+  std::array<std::vector<kit::ResourceType>, Player::COUNT> unlockedResources;
+
+  void clear();
 };
 
 struct GameState
@@ -20,25 +39,39 @@ struct GameState
   size_t currentTurn = 0;
 
   Map map;
-  std::vector<std::unique_ptr<City>> cities;
-  std::vector<std::unique_ptr<Bot>> bots;
+  std::vector<City> cities;
+  const UnitStore *unitStore = nullptr;
+  std::vector<unithandle_t> units; // in the order they were received, see UnitStore
+  TileOccupancy occupancy;
 
   // used to update influence maps
   std::vector<tileindex_t> resourcesIndex;
   std::vector<Bot*> citiesBot;
 
-  size_t playerResearchPoints[2];
+  size_t playerResearchPoints[2]{};
 
   InfluenceMap citiesInfluence;
   InfluenceMap resourcesInfluence;
-  std::unordered_map<std::string, InfluenceMap> ennemyPath;
+  // stamps of resourcesInfluence when there are many resource tiles
+  TemplateSplat resourceStamps;
+  // 1 on ally cities, and what a worker collects in a turn on each unlocked resource tile. Pathing
+  // counts them around candidate tiles with region sums, see InfluenceMap::sumDiamond
+  InfluenceMap allyCityTiles;
+  InfluenceMap collectableResources;
+  // sum of the paths of all the enemies ever seen, see EnemyTrajectory
+  InfluenceMap ennemyPathInfluence;
+  std::unordered_map<unitid_t, EnemyTrajectory> ennemyTrajectories;
 
   // Used to choose if we can have more city or not
-  float resourcesRemaining;
+  float resourcesRemaining{};
 
+  // clears the state so that it can be filled with a new turn, buffers keep their capacity
+  void reset(int mapWidth, int mapHeight);
   std::optional<const Bot*> getEntityAt(tileindex_t tile) const { auto [x, y] = map.getTilePosition(tile); return getEntityAt(x, y); }
   std::optional<const Bot*> getEntityAt(int x, int y) const;
   void computeInfluence(const GameStateDiff &gameStateDiff);
+  // what a worker collects in a turn on a resource tile, 0 while the resource is not researched
+  int getCollectableAmount(const Tile &tile) const;
   std::vector<bool> shouldExpand();
 };
 
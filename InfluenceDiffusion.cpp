@@ -0,0 +1,80 @@
+#include "InfluenceDiffusion.h"
+
+#include <algorithm>
+
+void InfluenceDiffusion::propagate(std::span<const InfluenceMap *const> sources, int n, std::span<InfluenceMap> results)
+{
+  if (sources.empty()) return;
+  MULTIBENCHMARK_LAPBEGIN(propagateAllTimes);
+  int width = sources[0]->getWidth();
+  int height = sources[0]->getHeight();
+  resize(width, height, sources.size());
+  for (size_t map = 0; map < sources.size(); map++)
+    load(map, sources[map]->m_map.data());
+
+  run(n);
+
+  for (size_t map = 0; map < sources.size(); map++) {
+    InfluenceMap &result = results[map];
+    if (result.getWidth() != width || result.getHeight() != height)
+      result.setSize(width, height);
+    store(map, result.m_map.data());
+    result.m_sums.invalidate();
+  }
+  MULTIBENCHMARK_LAPEND(propagateAllTimes);
+}
+
+void InfluenceDiffusion::resize(int width, int height, size_t mapCount)
+{
+  if (width == m_width && height == m_height && mapCount == m_mapCount) return;
+  m_width = width;
+  m_height = height;
+  m_mapCount = mapCount;
+  m_stride = static_cast<size_t>(width) + 2;
+  // maps share their separating rows of zeros
+  size_t size = (mapCount * (height + 1) + 1) * m_stride;
+  // borders are never written to, they only have to be cleared when the layout changes
+  m_front.assign(size, 0.f);
+  m_back.assign(size, 0.f);
+}
+
+void InfluenceDiffusion::load(size_t map, const float *values)
+{
+  for (int y = 0; y < m_height; y++)
+    std::copy_n(values + y * m_width, m_width, getRow(m_front, map, y));
+}
+
+void InfluenceDiffusion::store(size_t map, float *values)
+{
+  for (int y = 0; y < m_height; y++)
+    std::copy_n(getRow(m_front, map, y), m_width, values + y * m_width);
+}
+
+void InfluenceDiffusion::run(int n)
+{
+  for (int k = 0; k < n; k++) {
+    sweep();
+    std::swap(m_front, m_back);
+  }
+}
+
+void InfluenceDiffusion::sweep()
+{
+  const size_t stride = m_stride;
+  for (size_t map = 0; map < m_mapCount; map++) {
+    for (int y = 0; y < m_height; y++) {
+      const float *__restrict source = getRow(m_front, map, y);
+      float *__restrict destination = getRow(m_back, map, y);
+      // same order of additions as the bounds checked version, adding the zeros of the
+      // border does not change the value
+      for (int x = 0; x < m_width; x++) {
+        float value = source[x];
+        value += source[x + stride] / 2.f;
+        value += source[x - stride] / 2.f;
+        value += source[x + 1] / 2.f;
+        value += source[x - 1] / 2.f;
+        destination[x] = value;
+      }
+    }
+  }
+}
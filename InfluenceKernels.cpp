@@ -0,0 +1,599 @@
+#include "InfluenceKernels.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define INFLUENCE_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// msvc lets any function use AVX2 intrinsics, gcc and clang must be told which ones do
+#if defined(INFLUENCE_KERNELS_X86) && !defined(_MSC_VER)
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+#define AVX2_FUNCTION
+#endif
+
+namespace influence_kernels
+{
+
+namespace scalar
+{
+
+void fill(float *dst, float value, size_t count)
+{
+  std::fill(dst, dst + count, value);
+}
+
+void addScaled(float *dst, const float *src, float weight, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+    dst[i] += src[i] * weight;
+}
+
+void multiplyScaled(float *dst, const float *src, float weight, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+    dst[i] *= src[i] * weight;
+}
+
+void flip(float *dst, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+    dst[i] = 1.0f - dst[i];
+}
+
+std::pair<float, float> minMax(const float *src, size_t count)
+{
+  float minVal = std::numeric_limits<float>::max();
+  float maxVal = std::numeric_limits<float>::lowest();
+  for (size_t i = 0; i < count; i++) {
+    minVal = std::min(src[i], minVal);
+    maxVal = std::max(src[i], maxVal);
+  }
+  return { minVal, maxVal };
+}
+
+void rescale(float *dst, float minVal, float range, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+    dst[i] = (dst[i] - minVal) / range;
+}
+
+size_t argmax(const float *src, size_t count)
+{
+  return std::max_element(src, src + count) - src;
+}
+
+size_t findAtLeast(const float *src, size_t count, float threshold)
+{
+  size_t i = 0;
+  while (i < count && !(src[i] >= threshold))
+    i++;
+  return i;
+}
+
+void findPositive(const float *src, size_t count, uint64_t *words)
+{
+  std::fill_n(words, (count + 63) / 64, uint64_t{ 0 });
+  for (size_t i = 0; i < count; i++) {
+    if (src[i] > 0)
+      words[i / 64] |= uint64_t{ 1 } << (i % 64);
+  }
+}
+
+// x^exponent by squaring, the vector versions multiply in the same order
+float power(float x, unsigned exponent)
+{
+  float result = 1.f;
+  for (; exponent; exponent >>= 1) {
+    if (exponent & 1) result *= x;
+    x *= x;
+  }
+  return result;
+}
+
+// index i goes to lane i % VECTOR_WIDTH, 'begin' lets the vector versions finish their tail here
+template <class Power>
+void accumulateSimilarity(float *sums, float *counts, const float *a, const float *b, size_t begin, size_t count, Power &&power)
+{
+  for (size_t i = begin; i < count; i++) {
+    if (a[i] == 0 && b[i] == 0) continue;
+    counts[i % VECTOR_WIDTH]++;
+    sums[i % VECTOR_WIDTH] += std::max(0.f, 1 - power(std::abs(a[i] - b[i])));
+  }
+}
+
+std::pair<float, float> reduceLanes(const float *sums, const float *counts)
+{
+  float sum = 0, count = 0;
+  for (size_t lane = 0; lane < VECTOR_WIDTH; lane++) {
+    sum += sums[lane];
+    count += counts[lane];
+  }
+  return { sum, count };
+}
+
+std::pair<float, float> similarity(const float *a, const float *b, size_t count, unsigned exponent)
+{
+  float sums[VECTOR_WIDTH] = {}, counts[VECTOR_WIDTH] = {};
+  accumulateSimilarity(sums, counts, a, b, 0, count, [exponent](float x) { return power(x, exponent); });
+  return reduceLanes(sums, counts);
+}
+
+std::pair<float, float> similarityPowf(const float *a, const float *b, size_t count, float tolerance)
+{
+  float sums[VECTOR_WIDTH] = {}, counts[VECTOR_WIDTH] = {};
+  accumulateSimilarity(sums, counts, a, b, 0, count, [tolerance](float x) { return std::pow(x, tolerance); });
+  return reduceLanes(sums, counts);
+}
+
+}
+
+#ifdef INFLUENCE_KERNELS_X86
+
+// fill, addScaled and multiplyScaled have no SSE2 version, the table uses the scalar loops
+namespace sse2
+{
+
+void flip(float *dst, size_t count)
+{
+  __m128 one = _mm_set1_ps(1.0f);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(dst + i, _mm_sub_ps(one, _mm_loadu_ps(dst + i)));
+  scalar::flip(dst + i, count - i);
+}
+
+std::pair<float, float> minMax(const float *src, size_t count)
+{
+  __m128 minV = _mm_set1_ps(std::numeric_limits<float>::max());
+  __m128 maxV = _mm_set1_ps(std::numeric_limits<float>::lowest());
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 v = _mm_loadu_ps(src + i);
+    minV = _mm_min_ps(minV, v);
+    maxV = _mm_max_ps(maxV, v);
+  }
+  alignas(16) float mins[4], maxs[4];
+  _mm_store_ps(mins, minV);
+  _mm_store_ps(maxs, maxV);
+  auto [minVal, maxVal] = scalar::minMax(src + i, count - i);
+  for (int lane = 0; lane < 4; lane++) {
+    minVal = std::min(mins[lane], minVal);
+    maxVal = std::max(maxs[lane], maxVal);
+  }
+  return { minVal, maxVal };
+}
+
+void rescale(float *dst, float minVal, float range, size_t count)
+{
+  __m128 minV = _mm_set1_ps(minVal);
+  __m128 rangeV = _mm_set1_ps(range);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(dst + i, _mm_div_ps(_mm_sub_ps(_mm_loadu_ps(dst + i), minV), rangeV));
+  scalar::rescale(dst + i, minVal, range, count - i);
+}
+
+size_t argmax(const float *src, size_t count)
+{
+  if (count < 4) return scalar::argmax(src, count);
+  // each lane keeps its first maximum, strictly greater values replace it
+  __m128 best = _mm_loadu_ps(src);
+  __m128i bestIndex = _mm_setr_epi32(0, 1, 2, 3);
+  __m128i index = bestIndex;
+  const __m128i step = _mm_set1_epi32(4);
+  size_t i = 4;
+  for (; i + 4 <= count; i += 4) {
+    index = _mm_add_epi32(index, step);
+    __m128 v = _mm_loadu_ps(src + i);
+    __m128 greater = _mm_cmpgt_ps(v, best);
+    best = _mm_or_ps(_mm_and_ps(greater, v), _mm_andnot_ps(greater, best));
+    __m128i greaterMask = _mm_castps_si128(greater);
+    bestIndex = _mm_or_si128(_mm_and_si128(greaterMask, index), _mm_andnot_si128(greaterMask, bestIndex));
+  }
+  alignas(16) float values[4];
+  alignas(16) int32_t indices[4];
+  _mm_store_ps(values, best);
+  _mm_store_si128(reinterpret_cast<__m128i *>(indices), bestIndex);
+  size_t bestLane = 0;
+  for (int lane = 1; lane < 4; lane++) {
+    if (values[lane] > values[bestLane] || (values[lane] == values[bestLane] && indices[lane] < indices[bestLane]))
+      bestLane = lane;
+  }
+  float bestValue = values[bestLane];
+  size_t result = indices[bestLane];
+  for (; i < count; i++) {
+    if (src[i] > bestValue) {
+      bestValue = src[i];
+      result = i;
+    }
+  }
+  return result;
+}
+
+size_t findAtLeast(const float *src, size_t count, float threshold)
+{
+  __m128 t = _mm_set1_ps(threshold);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    int mask = _mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(src + i), t));
+    if (mask) return i + std::countr_zero(static_cast<unsigned>(mask));
+  }
+  return i + scalar::findAtLeast(src + i, count - i, threshold);
+}
+
+void findPositive(const float *src, size_t count, uint64_t *words)
+{
+  const __m128 zero = _mm_setzero_ps();
+  size_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    uint64_t word = 0;
+    for (int k = 0; k < 16; k++)
+      word |= static_cast<uint64_t>(_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(src + i + k * 4), zero))) << (k * 4);
+    words[i / 64] = word;
+  }
+  scalar::findPositive(src + i, count - i, words + i / 64);
+}
+
+__m128 power(__m128 x, unsigned exponent)
+{
+  __m128 result = _mm_set1_ps(1.f);
+  for (; exponent; exponent >>= 1) {
+    if (exponent & 1) result = _mm_mul_ps(result, x);
+    x = _mm_mul_ps(x, x);
+  }
+  return result;
+}
+
+// lanes 0-3 and 4-7 are kept in two registers
+std::pair<float, float> similarity(const float *a, const float *b, size_t count, unsigned exponent)
+{
+  const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f);
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 sums[2] = { zero, zero }, counts[2] = { zero, zero };
+  size_t i = 0;
+  for (; i + VECTOR_WIDTH <= count; i += VECTOR_WIDTH) {
+    for (int half = 0; half < 2; half++) {
+      __m128 va = _mm_loadu_ps(a + i + half * 4), vb = _mm_loadu_ps(b + i + half * 4);
+      __m128 used = _mm_or_ps(_mm_cmpneq_ps(va, zero), _mm_cmpneq_ps(vb, zero));
+      __m128 value = _mm_max_ps(_mm_sub_ps(one, power(_mm_and_ps(_mm_sub_ps(va, vb), absMask), exponent)), zero);
+      counts[half] = _mm_add_ps(counts[half], _mm_and_ps(used, one));
+      sums[half] = _mm_add_ps(sums[half], _mm_and_ps(used, value));
+    }
+  }
+  alignas(16) float laneSums[VECTOR_WIDTH], laneCounts[VECTOR_WIDTH];
+  for (int half = 0; half < 2; half++) {
+    _mm_store_ps(laneSums + half * 4, sums[half]);
+    _mm_store_ps(laneCounts + half * 4, counts[half]);
+  }
+  scalar::accumulateSimilarity(laneSums, laneCounts, a, b, i, count, [exponent](float x) { return scalar::power(x, exponent); });
+  return scalar::reduceLanes(laneSums, laneCounts);
+}
+
+}
+
+namespace avx2
+{
+
+AVX2_FUNCTION void fill(float *dst, float value, size_t count)
+{
+  __m256 v = _mm256_set1_ps(value);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(dst + i, v);
+  scalar::fill(dst + i, value, count - i);
+}
+
+AVX2_FUNCTION void addScaled(float *dst, const float *src, float weight, size_t count)
+{
+  __m256 w = _mm256_set1_ps(weight);
+  size_t i = 0;
+  // no fma, the rounding must stay the same as the scalar version
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), w)));
+  scalar::addScaled(dst + i, src + i, weight, count - i);
+}
+
+AVX2_FUNCTION void multiplyScaled(float *dst, const float *src, float weight, size_t count)
+{
+  __m256 w = _mm256_set1_ps(weight);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), w)));
+  scalar::multiplyScaled(dst + i, src + i, weight, count - i);
+}
+
+AVX2_FUNCTION void flip(float *dst, size_t count)
+{
+  __m256 one = _mm256_set1_ps(1.0f);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(dst + i, _mm256_sub_ps(one, _mm256_loadu_ps(dst + i)));
+  scalar::flip(dst + i, count - i);
+}
+
+AVX2_FUNCTION std::pair<float, float> minMax(const float *src, size_t count)
+{
+  __m256 minV = _mm256_set1_ps(std::numeric_limits<float>::max());
+  __m256 maxV = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 v = _mm256_loadu_ps(src + i);
+    minV = _mm256_min_ps(minV, v);
+    maxV = _mm256_max_ps(maxV, v);
+  }
+  alignas(32) float mins[8], maxs[8];
+  _mm256_store_ps(mins, minV);
+  _mm256_store_ps(maxs, maxV);
+  auto [minVal, maxVal] = scalar::minMax(src + i, count - i);
+  for (int lane = 0; lane < 8; lane++) {
+    minVal = std::min(mins[lane], minVal);
+    maxVal = std::max(maxs[lane], maxVal);
+  }
+  return { minVal, maxVal };
+}
+
+AVX2_FUNCTION void rescale(float *dst, float minVal, float range, size_t count)
+{
+  __m256 minV = _mm256_set1_ps(minVal);
+  __m256 rangeV = _mm256_set1_ps(range);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(dst + i, _mm256_div_ps(_mm256_sub_ps(_mm256_loadu_ps(dst + i), minV), rangeV));
+  scalar::rescale(dst + i, minVal, range, count - i);
+}
+
+AVX2_FUNCTION size_t argmax(const float *src, size_t count)
+{
+  if (count < 8) return scalar::argmax(src, count);
+  // each lane keeps its first maximum, strictly greater values replace it
+  __m256 best = _mm256_loadu_ps(src);
+  __m256i bestIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  __m256i index = bestIndex;
+  const __m256i step = _mm256_set1_epi32(8);
+  size_t i = 8;
+  for (; i + 8 <= count; i += 8) {
+    index = _mm256_add_epi32(index, step);
+    __m256 v = _mm256_loadu_ps(src + i);
+    __m256 greater = _mm256_cmp_ps(v, best, _CMP_GT_OQ);
+    best = _mm256_blendv_ps(best, v, greater);
+    bestIndex = _mm256_blendv_epi8(bestIndex, index, _mm256_castps_si256(greater));
+  }
+  alignas(32) float values[8];
+  alignas(32) int32_t indices[8];
+  _mm256_store_ps(values, best);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(indices), bestIndex);
+  size_t bestLane = 0;
+  for (int lane = 1; lane < 8; lane++) {
+    if (values[lane] > values[bestLane] || (values[lane] == values[bestLane] && indices[lane] < indices[bestLane]))
+      bestLane = lane;
+  }
+  float bestValue = values[bestLane];
+  size_t result = indices[bestLane];
+  for (; i < count; i++) {
+    if (src[i] > bestValue) {
+      bestValue = src[i];
+      result = i;
+    }
+  }
+  return result;
+}
+
+AVX2_FUNCTION size_t findAtLeast(const float *src, size_t count, float threshold)
+{
+  __m256 t = _mm256_set1_ps(threshold);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(src + i), t, _CMP_GE_OQ));
+    if (mask) return i + std::countr_zero(static_cast<unsigned>(mask));
+  }
+  return i + scalar::findAtLeast(src + i, count - i, threshold);
+}
+
+AVX2_FUNCTION void findPositive(const float *src, size_t count, uint64_t *words)
+{
+  const __m256 zero = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    uint64_t word = 0;
+    for (int k = 0; k < 8; k++)
+      word |= static_cast<uint64_t>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(src + i + k * 8), zero, _CMP_GT_OQ))) << (k * 8);
+    words[i / 64] = word;
+  }
+  scalar::findPositive(src + i, count - i, words + i / 64);
+}
+
+AVX2_FUNCTION __m256 power(__m256 x, unsigned exponent)
+{
+  __m256 result = _mm256_set1_ps(1.f);
+  for (; exponent; exponent >>= 1) {
+    if (exponent & 1) result = _mm256_mul_ps(result, x);
+    x = _mm256_mul_ps(x, x);
+  }
+  return result;
+}
+
+AVX2_FUNCTION std::pair<float, float> similarity(const float *a, const float *b, size_t count, unsigned exponent)
+{
+  const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.f);
+  const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  __m256 sums = zero, counts = zero;
+  size_t i = 0;
+  for (; i + VECTOR_WIDTH <= count; i += VECTOR_WIDTH) {
+    __m256 va = _mm256_loadu_ps(a + i), vb = _mm256_loadu_ps(b + i);
+    __m256 used = _mm256_or_ps(_mm256_cmp_ps(va, zero, _CMP_NEQ_UQ), _mm256_cmp_ps(vb, zero, _CMP_NEQ_UQ));
+    __m256 value = _mm256_max_ps(_mm256_sub_ps(one, power(_mm256_and_ps(_mm256_sub_ps(va, vb), absMask), exponent)), zero);
+    counts = _mm256_add_ps(counts, _mm256_and_ps(used, one));
+    sums = _mm256_add_ps(sums, _mm256_and_ps(used, value));
+  }
+  alignas(32) float laneSums[VECTOR_WIDTH], laneCounts[VECTOR_WIDTH];
+  _mm256_store_ps(laneSums, sums);
+  _mm256_store_ps(laneCounts, counts);
+  scalar::accumulateSimilarity(laneSums, laneCounts, a, b, i, count, [exponent](float x) { return scalar::power(x, exponent); });
+  return scalar::reduceLanes(laneSums, laneCounts);
+}
+
+}
+
+#endif
+
+namespace
+{
+
+struct KernelTable
+{
+  void (*fill)(float *, float, size_t);
+  void (*addScaled)(float *, const float *, float, size_t);
+  void (*multiplyScaled)(float *, const float *, float, size_t);
+  void (*flip)(float *, size_t);
+  std::pair<float, float> (*minMax)(const float *, size_t);
+  void (*rescale)(float *, float, float, size_t);
+  size_t (*argmax)(const float *, size_t);
+  size_t (*findAtLeast)(const float *, size_t, float);
+  void (*findPositive)(const float *, size_t, uint64_t *);
+  std::pair<float, float> (*similarity)(const float *, const float *, size_t, unsigned);
+};
+
+// 'streams' gives fill, addScaled and multiplyScaled
+#define KERNEL_TABLE(ns, streams) KernelTable{ streams::fill, streams::addScaled, streams::multiplyScaled, ns::flip, ns::minMax, ns::rescale, ns::argmax, ns::findAtLeast, ns::findPositive, ns::similarity }
+
+KernelTable makeTable(InstructionSet instructionSet)
+{
+  switch (instructionSet) {
+#ifdef INFLUENCE_KERNELS_X86
+  case InstructionSet::AVX2: return KERNEL_TABLE(avx2, avx2);
+  case InstructionSet::SSE2: return KERNEL_TABLE(sse2, scalar);
+#endif
+  default:                   return KERNEL_TABLE(scalar, scalar);
+  }
+}
+
+bool cpuSupportsAvx2()
+{
+#if !defined(INFLUENCE_KERNELS_X86)
+  return false;
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) return false;
+  __cpuid(info, 1);
+  bool osSavesAvxState = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+  if (!osSavesAvxState) return false;
+  __cpuidex(info, 7, 0);
+  return info[1] & (1 << 5);
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+struct Dispatch
+{
+  InstructionSet instructionSet = getBestInstructionSet();
+  KernelTable kernels = makeTable(instructionSet);
+};
+
+Dispatch &dispatch()
+{
+  static Dispatch s_dispatch;
+  return s_dispatch;
+}
+
+}
+
+InstructionSet getBestInstructionSet()
+{
+#ifdef INFLUENCE_KERNELS_X86
+  static const InstructionSet best = cpuSupportsAvx2() ? InstructionSet::AVX2 : InstructionSet::SSE2;
+  return best;
+#else
+  return InstructionSet::SCALAR;
+#endif
+}
+
+InstructionSet getInstructionSet()
+{
+  return dispatch().instructionSet;
+}
+
+void setInstructionSet(InstructionSet instructionSet)
+{
+  dispatch().instructionSet = std::min(instructionSet, getBestInstructionSet());
+  dispatch().kernels = makeTable(dispatch().instructionSet);
+}
+
+const char *getName(InstructionSet instructionSet)
+{
+  switch (instructionSet) {
+  case InstructionSet::AVX2: return "avx2";
+  case InstructionSet::SSE2: return "sse2";
+  default:                   return "scalar";
+  }
+}
+
+void fill(float *dst, float value, size_t count)
+{
+  dispatch().kernels.fill(dst, value, count);
+}
+
+void addScaled(float *dst, const float *src, float weight, size_t count)
+{
+  dispatch().kernels.addScaled(dst, src, weight, count);
+}
+
+void multiplyScaled(float *dst, const float *src, float weight, size_t count)
+{
+  dispatch().kernels.multiplyScaled(dst, src, weight, count);
+}
+
+void flip(float *dst, size_t count)
+{
+  dispatch().kernels.flip(dst, count);
+}
+
+std::pair<float, float> minMax(const float *src, size_t count)
+{
+  return dispatch().kernels.minMax(src, count);
+}
+
+void normalize(float *dst, size_t count)
+{
+  const KernelTable &kernels = dispatch().kernels;
+  auto [minVal, maxVal] = kernels.minMax(dst, count);
+  if (minVal == maxVal)
+    return;
+  kernels.rescale(dst, minVal, maxVal - minVal, count);
+}
+
+size_t argmax(const float *src, size_t count)
+{
+  return dispatch().kernels.argmax(src, count);
+}
+
+size_t findAtLeast(const float *src, size_t count, float threshold)
+{
+  return dispatch().kernels.findAtLeast(src, count, threshold);
+}
+
+void findPositive(const float *src, size_t count, uint64_t *words)
+{
+  dispatch().kernels.findPositive(src, count, words);
+}
+
+std::pair<float, float> similarity(const float *a, const float *b, size_t count, float tolerance)
+{
+  if (tolerance >= 0 && tolerance <= MAX_INTEGER_TOLERANCE && tolerance == std::floor(tolerance))
+    return dispatch().kernels.similarity(a, b, count, static_cast<unsigned>(tolerance));
+  return scalar::similarityPowf(a, b, count, tolerance);
+}
+
+}
@@ -0,0 +1,58 @@
+#ifndef INFLUENCE_KERNELS_H
+#define INFLUENCE_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Vectorized loops behind the element-wise InfluenceMap operations.
+// The instruction set is picked at startup from what the cpu supports (AVX2, SSE2 or
+// plain scalar code), every version gives the same results as the scalar one.
+// Buffers are expected to be ALIGNMENT aligned, counts do not have to be multiples of
+// the vector width.
+namespace influence_kernels
+{
+
+static constexpr size_t ALIGNMENT = 32;
+static constexpr size_t VECTOR_WIDTH = 8; // floats per AVX register
+
+enum class InstructionSet
+{
+  SCALAR,
+  SSE2,
+  AVX2,
+};
+
+InstructionSet getBestInstructionSet();
+InstructionSet getInstructionSet();
+// falls back to the best supported set, used to compare implementations
+void setInstructionSet(InstructionSet instructionSet);
+const char *getName(InstructionSet instructionSet);
+
+void fill(float *dst, float value, size_t count);
+// dst[i] += src[i] * weight
+void addScaled(float *dst, const float *src, float weight, size_t count);
+// dst[i] *= src[i] * weight
+void multiplyScaled(float *dst, const float *src, float weight, size_t count);
+// dst[i] = 1 - dst[i]
+void flip(float *dst, size_t count);
+std::pair<float, float> minMax(const float *src, size_t count);
+// rescales to [0,1] after a single min/max pass, does nothing if all values are equal
+void normalize(float *dst, size_t count);
+// index of the first maximum, like std::max_element
+size_t argmax(const float *src, size_t count);
+// index of the first value >= threshold, count if there is none
+size_t findAtLeast(const float *src, size_t count, float threshold);
+// sets bit i % 64 of words[i / 64] when src[i] > 0 and clears it otherwise, the unused bits
+// of the last word are cleared
+void findPositive(const float *src, size_t count, uint64_t *words);
+// sum of max(0, 1 - |a[i] - b[i]|^tolerance) over the indices where a[i] or b[i] is not 0,
+// and the number of such indices, see InfluenceMap::getSimilarity
+// integer tolerances up to MAX_INTEGER_TOLERANCE are raised with multiplications instead of
+// powf, sums are accumulated in VECTOR_WIDTH lanes by every version
+static constexpr float MAX_INTEGER_TOLERANCE = 32.f;
+std::pair<float, float> similarity(const float *a, const float *b, size_t count, float tolerance);
+
+}
+
+#endif
@@ -1,8 +1,8 @@
 #include "InfluenceMap.h"
+#include "InfluenceDiffusion.h"
 #include <string>
 #include <iostream>
 #include <algorithm>
-#include <execution>
 
 #ifdef _DEBUG
 std::mt19937 g_randomEngine{ 0 };
@@ -10,158 +10,120 @@ std::mt19937 g_randomEngine{ 0 };
 std::mt19937 g_randomEngine{ std::random_device{}()};
 #endif
 
-constexpr float PI = 3.14159265359f;
-
-InfluenceMap::InfluenceMap(InfluenceMap &&moved)
+template <class Storage>
+BasicInfluenceMap<Storage>::BasicInfluenceMap(BasicInfluenceMap &&moved)
   : m_width(std::exchange(moved.m_width, 0))
   , m_height(std::exchange(moved.m_height, 0))
-  , m_map(std::exchange(moved.m_map, {}))
+  , m_map(std::move(moved.m_map))
+  , m_sums(std::move(moved.m_sums))
 {
+  moved.m_map.resize(0);
 }
 
-InfluenceMap &InfluenceMap::operator=(InfluenceMap &&moved)
+template <class Storage>
+BasicInfluenceMap<Storage> &BasicInfluenceMap<Storage>::operator=(BasicInfluenceMap &&moved)
 {
-  InfluenceMap{ std::move(moved) }.swap(*this);
+  if (this == &moved) return *this;
+  m_width = std::exchange(moved.m_width, 0);
+  m_height = std::exchange(moved.m_height, 0);
+  m_map = std::move(moved.m_map);
+  m_sums = std::move(moved.m_sums);
+  moved.m_map.resize(0);
   return *this;
 }
 
-void InfluenceMap::swap(InfluenceMap &other)
+template <class Storage>
+void BasicInfluenceMap<Storage>::swap(BasicInfluenceMap &other)
 {
   std::swap(m_width, other.m_width);
   std::swap(m_height, other.m_height);
   std::swap(m_map, other.m_map);
+  std::swap(m_sums, other.m_sums);
 }
 
-void InfluenceMap::setSize(int width, int height)
+template <class Storage>
+void BasicInfluenceMap<Storage>::setSize(int width, int height)
 {
   m_width = width;
   m_height = height;
-  m_map.clear();
-  m_map.resize(width * height, 0.0f);
-}
-
-InfluenceMap& InfluenceMap::propagate(tileindex_t index, float initialInfluence, float(*propagationFunction)(float, float), int range)
-{
-  auto [x1, y1] = getCoord(index);
-
-  for (int y2 = std::max(0, y1 - range); y2 < std::min(m_height, y1 + range + 1); ++y2) {
-    for (int x2 = std::max(0, x1 - range); x2 < std::min(m_width, x1 + range + 1); ++x2) {
-      m_map[getIndex(x2, y2)] += propagationFunction(initialInfluence, static_cast<float>(std::abs(x1 - x2) + std::abs(y1 - y2)));
-    }
-  }
-
-  return *this;
+  m_map.resize(getPaddedSize(width, height));
+  m_sums.invalidate();
 }
 
-InfluenceMap& InfluenceMap::setValueAtIndex(tileindex_t index, float value)
+template <class Storage>
+BasicInfluenceMap<Storage>& BasicInfluenceMap<Storage>::setValueAtIndex(tileindex_t index, float value)
 {
   m_map[index] = value;
+  m_sums.invalidate();
   return *this;
 }
 
-InfluenceMap& InfluenceMap::addValueAtIndex(tileindex_t index, float value)
+template <class Storage>
+BasicInfluenceMap<Storage>& BasicInfluenceMap<Storage>::addValueAtIndex(tileindex_t index, float value)
 {
   m_map[index] += value;
+  m_sums.invalidate();
   return *this;
 }
 
-InfluenceMap& InfluenceMap::multiplyValueAtIndex(tileindex_t index, float value)
+template <class Storage>
+BasicInfluenceMap<Storage>& BasicInfluenceMap<Storage>::multiplyValueAtIndex(tileindex_t index, float value)
 {
   m_map[index] *= value;
+  m_sums.invalidate();
   return *this;
 }
 
-InfluenceMap& InfluenceMap::addMap(const InfluenceMap &influenceMap, float weight)
+template <class Storage>
+BasicInfluenceMap<Storage>& BasicInfluenceMap<Storage>::addMap(const BasicInfluenceMap &influenceMap, float weight)
 {
-  std::transform(std::execution::seq, m_map.begin(), m_map.end(), influenceMap.m_map.begin(), m_map.begin(),
-      [weight](float currentScore, float otherScore) {
-    return currentScore + (otherScore * weight);
-  });
-
+  influence_kernels::addScaled(m_map.data(), influenceMap.m_map.data(), weight, m_map.size());
+  m_sums.invalidate();
   return *this;
 }
 
-InfluenceMap& InfluenceMap::multiplyMap(const InfluenceMap &influenceMap, float weight)
+template <class Storage>
+BasicInfluenceMap<Storage>& BasicInfluenceMap<Storage>::multiplyMap(const BasicInfluenceMap &influenceMap, float weight)
 {
-  std::transform(std::execution::seq, m_map.begin(), m_map.end(), influenceMap.m_map.begin(), m_map.begin(),
-      [weight](float currentScore, float otherScore) {
-    return currentScore * (otherScore * weight);
-  });
-
+  influence_kernels::multiplyScaled(m_map.data(), influenceMap.m_map.data(), weight, m_map.size());
+  m_sums.invalidate();
   return *this;
 }
 
-InfluenceMap& InfluenceMap::normalize()
+template <class Storage>
+BasicInfluenceMap<Storage>& BasicInfluenceMap<Storage>::normalize()
 {
-  float minVal = std::numeric_limits<float>::max();
-  float maxVal = std::numeric_limits<float>::lowest();
-  for(float val : m_map) {
-    minVal = std::min(val, minVal);
-    maxVal = std::max(val, maxVal);
-  }
-  if (minVal == maxVal)
-    return *this;
-
-  std::transform(std::execution::seq, m_map.begin(), m_map.end(), m_map.begin(),
-    [minVal, maxVal](float score) { return (score - minVal) / (maxVal - minVal); });
-
+  influence_kernels::normalize(m_map.data(), getSize());
+  m_sums.invalidate();
   return *this;
 }
 
-InfluenceMap& InfluenceMap::flip()
+template <class Storage>
+BasicInfluenceMap<Storage>& BasicInfluenceMap<Storage>::flip()
 {
-  std::transform(std::execution::seq, m_map.begin(), m_map.end(), m_map.begin(),
-      [](float score) { return 1.0f - score; });
-
+  influence_kernels::flip(m_map.data(), m_map.size());
+  m_sums.invalidate();
   return *this;
 }
 
-tileindex_t InfluenceMap::getHighestPoint() const
-{
-  auto maxIterator = std::ranges::max_element(m_map);
-  return static_cast<int>(std::distance(m_map.begin(), maxIterator));
-}
-
-std::vector<tileindex_t> InfluenceMap::getNHighestPoints(int n) const
+template <class Storage>
+tileindex_t BasicInfluenceMap<Storage>::getHighestPoint() const
 {
-  // Create a vector of pairs where the first element of the pair is the value
-  // and the second element is the index
-  std::vector<std::pair<float, tileindex_t>> indexedVec;
-  indexedVec.reserve(m_map.size());
-  for (tileindex_t i = 0; i < m_map.size(); ++i) {
-    indexedVec.emplace_back(m_map[i], i);
-  }
-
-  // Partially sort the indexed vector based on the values
-  std::ranges::partial_sort(indexedVec, indexedVec.begin() + n, std::greater());
-
-  std::vector<tileindex_t> resultIndices;
-  resultIndices.reserve(n);
-  for (tileindex_t i = 0; i < n && i < indexedVec.size(); ++i)
-    resultIndices.push_back(indexedVec[i].second);
-  while (resultIndices.size() < n)
-    resultIndices.push_back(-1);
-
-  return resultIndices;
+  return static_cast<tileindex_t>(influence_kernels::argmax(m_map.data(), getSize()));
 }
 
-float InfluenceMap::getSimilarity(const InfluenceMap &map2, float similarityTolerance) const
+template <class Storage>
+float BasicInfluenceMap<Storage>::getSimilarity(const BasicInfluenceMap &map2, float similarityTolerance) const
 {
   if (getWidth() != map2.getWidth() || getHeight() != map2.getHeight())
     throw std::runtime_error("Cannot compare maps of different sizes");
 
-  float similarity = 0;
-  float count = 0;
-  for (int i = 0; i < getSize(); i++) 
-  {
-      if (m_map[i] == 0 && map2.m_map[i] == 0) continue;
-      count++;
-      similarity += std::max(0.f, 1 - std::powf(std::abs(m_map[i] - map2.m_map[i]), similarityTolerance));
-  }
+  auto [similarity, count] = influence_kernels::similarity(m_map.data(), map2.m_map.data(), getSize(), similarityTolerance);
   return similarity * 100.f / count;
 }
 
-std::pair<tileindex_t, tileindex_t> InfluenceMap::getStartAndEndOfPath()
+template <class Storage>
+std::pair<tileindex_t, tileindex_t> BasicInfluenceMap<Storage>::getStartAndEndOfPath()
 {
   tileindex_t start = 0;
   float sValue = 2;
@@ -182,98 +144,37 @@ std::pair<tileindex_t, tileindex_t> InfluenceMap::getStartAndEndOfPath()
   return { start, end };
 }
 
-bool InfluenceMap::coversPercentage(const InfluenceMap &mapToCover, float coverageNeeded) const
+template <class Storage>
+bool BasicInfluenceMap<Storage>::coversPercentage(const BasicInfluenceMap &mapToCover, float coverageNeeded) const
 {
-  float total = 0;
-  float covered = 0;
-  for (int i = 0; i < getSize(); i++) {
-    if (mapToCover.m_map[i] > 0) {
-      total++;
-      if (m_map[i] > 0)
-        covered++;
-    }
-  }
+  TileSet tilesToCover = mapToCover.getPositiveTiles();
+  float total = static_cast<float>(tilesToCover.size());
+  float covered = static_cast<float>(getPositiveTiles().countCommon(tilesToCover));
   return covered/total*100.f > coverageNeeded;
 }
 
-bool InfluenceMap::coversTiles(const InfluenceMap &mapToCover, int tilesNeeded) const
+template <class Storage>
+bool BasicInfluenceMap<Storage>::coversTiles(const BasicInfluenceMap &mapToCover, int tilesNeeded) const
 {
-    int covered = 0;
-    for (int i = 0; i < getSize(); i++) {
-        if (mapToCover.m_map[i] > 0) {
-            if (m_map[i] > 0) {
-                covered++;
-                if (covered >= tilesNeeded)
-                {
-                    return true;
-                }
-            }
-        }
-    }
-    return false;
-}
-
-bool InfluenceMap::approachesPoint(int tile_x, int tile_y, int length, int step) const
-{
-  float angle = PI/4.f;
-
-  // we collect the points corresponding to each turn - i * step, for i in [|0, length/step|]
-  std::vector<std::pair<tileindex_t, float>> distances{};
-  // we seek in the map
-  for (tileindex_t i = 0; i < getSize(); i++)
-  {
-      if (m_map[i] > 0)
-          distances.emplace_back(i, m_map[i]);
-  }
-  std::ranges::sort(distances, std::less{});
-  std::pair<double, double> direction{};
-  if (distances.size() > step) {
-      std::pair<double, double> coords = getCoord(distances[distances.size()-1].first);
-      direction.first = (tile_x - coords.first) / sqrt(direction.first * direction.first + direction.second * direction.second);
-      direction.second = (tile_y - coords.second) / sqrt(direction.first * direction.first + direction.second * direction.second);
-      for (int i = 0; i < std::min(length, (int)distances.size() - step); i += step)
-      {
-          std::pair<double, double> direction_i{};
-          direction_i.first = distances[distances.size()-1-i].first - distances[distances.size()-1-i-step].first;
-          direction_i.second = distances[distances.size()-1-i].second - distances[distances.size()-1-i-step].second;
-          direction_i.first /= sqrt(direction_i.first * direction_i.first + direction_i.second * direction_i.second);
-          direction_i.second /= sqrt(direction_i.first * direction_i.first + direction_i.second * direction_i.second);
-          double scalar = direction.first * direction_i.first + direction.second * direction_i.second;
-          if (std::abs(std::acos(scalar)) > angle)
-              return false;
-      }
-      return true;
-  } else return false;
+  return getPositiveTiles().coversTiles(mapToCover.getPositiveTiles(), tilesNeeded);
 }
 
-std::pair<unsigned, unsigned> InfluenceMap::getRandomValuedPoint() const
+template <class Storage>
+std::pair<unsigned, unsigned> BasicInfluenceMap<Storage>::getRandomValuedPoint() const
 {
-  std::vector<tileindex_t> valuedPoints{};
-  for (int i = 0; i < getSize(); i++)
-    if (m_map[i] > 0)
-      valuedPoints.push_back(i);
-  return getCoord(valuedPoints[g_randomEngine()%valuedPoints.size()]);
+  TileSet valuedPoints = getPositiveTiles();
+  return getCoord(valuedPoints.getNth(g_randomEngine()%valuedPoints.size()));
 }
 
-InfluenceMap InfluenceMap::propagateAllTimes(int n) const
+template <class Storage>
+BasicInfluenceMap<Storage> BasicInfluenceMap<Storage>::propagateAllTimes(int n) const
 {
   if (n == 0) return *this;
-  MULTIBENCHMARK_LAPBEGIN(propagateAllTimes);
-  InfluenceMap i1{ *this };
-  InfluenceMap i2{ m_width, m_height };
-  for (int k = 0; k < n; k++) {
-    for (int i = 0; i < m_height; i++) {
-      for (int j = 0; j < m_width; j++) {
-        i2.m_map[i*m_width + j] = i1.m_map[i*m_width + j];
-        if (i < m_height-1) i2.m_map[i*m_width + j] += i1.m_map[(i+1)*m_width + j]/2.f;
-        if (i > 0)          i2.m_map[i*m_width + j] += i1.m_map[(i-1)*m_width + j]/2.f;
-        if (j < m_width-1)  i2.m_map[i*m_width + j] += i1.m_map[i*m_width + j + 1]/2.f;
-        if (j > 0)          i2.m_map[i*m_width + j] += i1.m_map[i*m_width + j - 1]/2.f;
-      }
-    }
-    std::swap(i1, i2);
-  }
-  MULTIBENCHMARK_LAPEND(propagateAllTimes);
-  return i1;
+  static InfluenceDiffusion s_diffusion;
+  BasicInfluenceMap propagated;
+  s_diffusion.propagate(*this, n, propagated);
+  return propagated;
 }
 
+template class BasicInfluenceMap<influence_storage::Inline<game_rules::MAX_MAP_SIZE * game_rules::MAX_MAP_SIZE>>;
+template class BasicInfluenceMap<influence_storage::Heap>;
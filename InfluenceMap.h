@@ -1,12 +1,19 @@
 #ifndef INFLUENCE_MAP_H
 #define INFLUENCE_MAP_H
 
+#include <algorithm>
 #include <array>
 #include <vector>
 #include <random>
 #include <iostream>
 
 #include "Benchmarking.h"
+#include "GameRules.h"
+#include "InfluenceKernels.h"
+#include "InfluenceStorage.h"
+#include "SummedAreaTable.h"
+#include "TileSet.h"
+#include "TopPoints.h"
 #include "Types.h"
 
 template <class T>
@@ -25,11 +32,13 @@ constexpr T power(T num, unsigned int pow, std::enable_if_t<std::is_arithmetic_v
 template <unsigned int W, unsigned int H>
 class InfluenceTemplate
 {
-  friend class InfluenceMap;
+  template <class Storage> friend class BasicInfluenceMap;
   std::array<float, W * H> m_map;
 
 public:
   constexpr InfluenceTemplate(int x1, int y1, float influence, float (*propagationFunction)(float, float));
+
+  constexpr float getValue(unsigned x, unsigned y) const { return m_map[x + y * W]; }
 };
 
 template <unsigned W, unsigned H>
@@ -43,109 +52,210 @@ constexpr InfluenceTemplate<W, H>::InfluenceTemplate(int x1, int y1, float influ
   }
 }
 
-class InfluenceMap
+namespace influence_templates
 {
+
+// manhattan distances to the center of a (2 * Range + 1)^2 box, the shape of
+// BasicInfluenceMap::propagate
+template <int Range>
+constexpr auto MANHATTAN_DISTANCES = [] {
+  constexpr int SIZE = 2 * Range + 1;
+  std::array<unsigned char, SIZE * SIZE> distances{};
+  for (int i = 0; i < SIZE * SIZE; i++)
+    distances[i] = static_cast<unsigned char>(absolute(i % SIZE - Range) + absolute(i / SIZE - Range));
+  return distances;
+}();
+
+}
+
+// Storage is one of the policies of InfluenceStorage.h, see InfluenceMap below.
+// Values are aligned for the vectorized kernels of InfluenceKernels.h and padded to a multiple
+// of their vector width, element-wise operations run over the padding, reductions stop at
+// getSize().
+template <class Storage>
+class BasicInfluenceMap
+{
+  friend class InfluenceDiffusion;
+  friend class TemplateSplat;
+
+  static size_t getPaddedSize(int width, int height)
+  {
+    constexpr size_t w = influence_kernels::VECTOR_WIDTH;
+    return (static_cast<size_t>(width) * height + w - 1) / w * w;
+  }
+
+  // calls op(value, x, y) for each tile of a W*H box centered on 'index', x and y being the
+  // position in the box. Boxes inside the map run with constant bounds, only those crossing a
+  // border are clipped.
+  template <unsigned W, unsigned H, class Op>
+  void forEachBoxTile(tileindex_t index, Op &&op);
+
+  const SummedAreaTable &getSums() const { return m_sums.get(m_map.data(), m_width, m_height); }
+
   int m_width{}, m_height{};
-  std::vector<float> m_map;
+  Storage m_map;
+  // every change of the values invalidates the tables
+  mutable SummedAreaCache m_sums;
 
 public:
-  InfluenceMap() = default;
-  InfluenceMap(int width, int height)
-    : m_width{ width }, m_height{ height }, m_map(static_cast<size_t>(width) *height, 0.f)
-  {}
+  BasicInfluenceMap() = default;
+  BasicInfluenceMap(int width, int height)
+    : m_width{ width }, m_height{ height }
+  {
+    m_map.resize(getPaddedSize(width, height));
+  }
 
-  InfluenceMap(const InfluenceMap &) = default;
-  InfluenceMap &operator=(const InfluenceMap &) = default;
-  InfluenceMap(InfluenceMap &&);
-  InfluenceMap &operator=(InfluenceMap &&);
+  BasicInfluenceMap(const BasicInfluenceMap &) = default;
+  BasicInfluenceMap &operator=(const BasicInfluenceMap &) = default;
+  BasicInfluenceMap(BasicInfluenceMap &&);
+  BasicInfluenceMap &operator=(BasicInfluenceMap &&);
 
-  void swap(InfluenceMap &);
+  void swap(BasicInfluenceMap &);
 
   void setSize(int width, int height);
 
   tileindex_t getIndex(int x, int y) const { return x + y * m_width; }
   float getValue(int x, int y) const { return getValue(getIndex(x, y)); }
   float getValue(tileindex_t index) const { return m_map[index]; }
+  const float *getRow(int y) const { return m_map.data() + y * m_width; }
   std::pair<int, int> getCoord(tileindex_t index) const { return { index % m_width, index / m_width }; }
   std::pair<int, int> getCenter() const { return { m_width / 2, m_height / 2 }; }
   int getSize() const { return m_width * m_height; }
   int getWidth() const { return m_width; }
   int getHeight() const { return m_height; }
 
-  void clear() { std::ranges::fill(m_map, 0.0f); }
+  void clear()
+  {
+    influence_kernels::fill(m_map.data(), 0.0f, m_map.size());
+    m_sums.invalidate();
+  }
+
+  // sum of the values in a rectangle (inclusive bounds) or of the tiles up to 'radius' tiles
+  // away in manhattan distance, clipped by the map borders. The first sum after a change builds
+  // summed-area tables in one pass over the map, the following ones take constant time.
+  float sumRect(int x0, int y0, int x1, int y1) const { return getSums().sumRect(x0, y0, x1, y1); }
+  float sumDiamond(int x, int y, int radius) const { return getSums().sumDiamond(x, y, radius); }
 
-  InfluenceMap& propagate(tileindex_t index, float initialInfluence, float (*propagationFunction)(float, float), int range);
-  InfluenceMap& setValueAtIndex(tileindex_t index, float value);
-  InfluenceMap& addValueAtIndex(tileindex_t index, float value);
-  InfluenceMap& multiplyValueAtIndex(tileindex_t index, float value);
+  // adds propagationFunction(initialInfluence, distance) to the tiles up to Range tiles away
+  // on each axis, distance being the manhattan distance to 'index'
+  template <int Range, auto propagationFunction>
+  BasicInfluenceMap& propagate(tileindex_t index, float initialInfluence);
+  BasicInfluenceMap& setValueAtIndex(tileindex_t index, float value);
+  BasicInfluenceMap& addValueAtIndex(tileindex_t index, float value);
+  BasicInfluenceMap& multiplyValueAtIndex(tileindex_t index, float value);
 
-  InfluenceMap& addMap(const InfluenceMap &influenceMap, float weight = 1.0f);
-  InfluenceMap& multiplyMap(const InfluenceMap &influenceMap, float weight = 1.0f);
+  BasicInfluenceMap& addMap(const BasicInfluenceMap &influenceMap, float weight = 1.0f);
+  BasicInfluenceMap& multiplyMap(const BasicInfluenceMap &influenceMap, float weight = 1.0f);
 
   template <unsigned int W, unsigned int H>
-  InfluenceMap& addTemplateAtIndex(tileindex_t index, const InfluenceTemplate<W, H> &influenceTemplate, float weight = 1.0f);
+  BasicInfluenceMap& addTemplateAtIndex(tileindex_t index, const InfluenceTemplate<W, H> &influenceTemplate, float weight = 1.0f);
 
   template <unsigned int W, unsigned int H>
-  InfluenceMap& multiplyTemplateAtIndex(tileindex_t index, const InfluenceTemplate<W, H> &influenceTemplate, float weight = 1.0f);
+  BasicInfluenceMap& multiplyTemplateAtIndex(tileindex_t index, const InfluenceTemplate<W, H> &influenceTemplate, float weight = 1.0f);
 
-  InfluenceMap& normalize();
-  InfluenceMap& flip();
+  BasicInfluenceMap& normalize();
+  BasicInfluenceMap& flip();
 
   tileindex_t getHighestPoint() const;
-  std::vector<tileindex_t> getNHighestPoints(int n) const;
+  // n tiles with the highest values in decreasing order, ties go to the highest tile and
+  // missing tiles are -1. Only tiles accepted by 'mask', a tileindex_t predicate, are selected.
+  template <class Mask = top_points::AllTiles>
+  std::vector<tileindex_t> getNHighestPoints(int n, const Mask &mask = {}) const;
 
   // Use to compare maps of similar size
-  float getSimilarity(const InfluenceMap &map2, float similarityTolerance = 1.f) const;
+  float getSimilarity(const BasicInfluenceMap &map2, float similarityTolerance = 1.f) const;
 
   // Useful only for paths
   std::pair<tileindex_t, tileindex_t> getStartAndEndOfPath();
 
-  bool coversPercentage(const InfluenceMap& mapToCover, float coverageNeeded) const;
+  // tiles with a positive value, the sparse form of a path, see TileSet
+  TileSet getPositiveTiles() const { return TileSet::positive(m_map.data(), getSize()); }
 
-  bool coversTiles(const InfluenceMap &mapToCover, int tilesNeeded) const;
+  bool coversPercentage(const BasicInfluenceMap& mapToCover, float coverageNeeded) const;
 
-  bool approachesPoint(int tile_x, int tile_y, int length, int step) const;
+  bool coversTiles(const BasicInfluenceMap &mapToCover, int tilesNeeded) const;
 
   std::pair<unsigned int, unsigned int> getRandomValuedPoint() const;
 
-  InfluenceMap propagateAllTimes(int n) const;
+  // see InfluenceDiffusion, which also propagates several maps at once
+  BasicInfluenceMap propagateAllTimes(int n) const;
 };
 
-template <unsigned W, unsigned H>
-InfluenceMap &InfluenceMap::addTemplateAtIndex(tileindex_t index, const InfluenceTemplate<W, H> &influenceTemplate, float weight)
+template <class Storage>
+template <unsigned W, unsigned H, class Op>
+void BasicInfluenceMap<Storage>::forEachBoxTile(tileindex_t index, Op &&op)
 {
-  int deltaX = index % m_width - W / 2;
-  int deltaY = index / m_width - H / 2;
-
-  for (int i = 0; i < W * H; ++i) {
-    int x = i % W + deltaX;
-    int y = i / W + deltaY;
-
-    if (x < 0 || x >= m_width || y < 0 || y >= m_height) continue;
+  m_sums.invalidate();
+  const int left = index % m_width - static_cast<int>(W / 2);
+  const int top = index / m_width - static_cast<int>(H / 2);
+
+  if (left >= 0 && top >= 0 && left + static_cast<int>(W) <= m_width && top + static_cast<int>(H) <= m_height) {
+    float *row = m_map.data() + getIndex(left, top);
+    for (unsigned y = 0; y < H; y++, row += m_width) {
+      for (unsigned x = 0; x < W; x++)
+        op(row[x], x, y);
+    }
+    return;
+  }
 
-    m_map[getIndex(x, y)] += influenceTemplate.m_map[i] * weight;
+  const int x0 = std::max(0, -left), x1 = std::min(static_cast<int>(W), m_width - left);
+  const int y0 = std::max(0, -top), y1 = std::min(static_cast<int>(H), m_height - top);
+  for (int y = y0; y < y1; y++) {
+    float *row = m_map.data() + getIndex(left + x0, top + y);
+    for (int x = x0; x < x1; x++)
+      op(row[x - x0], x, y);
   }
+}
 
+template <class Storage>
+template <int Range, auto propagationFunction>
+BasicInfluenceMap<Storage> &BasicInfluenceMap<Storage>::propagate(tileindex_t index, float initialInfluence)
+{
+  constexpr unsigned SIZE = 2 * Range + 1;
+  constexpr auto &distances = influence_templates::MANHATTAN_DISTANCES<Range>;
+  // the influence only depends on the distance, it is computed once per distance
+  std::array<float, 2 * Range + 1> influences;
+  for (int distance = 0; distance <= 2 * Range; distance++)
+    influences[distance] = propagationFunction(initialInfluence, static_cast<float>(distance));
+
+  forEachBoxTile<SIZE, SIZE>(index, [&](float &value, unsigned x, unsigned y) { value += influences[distances[x + y * SIZE]]; });
   return *this;
 }
 
+template <class Storage>
 template <unsigned W, unsigned H>
-InfluenceMap &InfluenceMap::multiplyTemplateAtIndex(tileindex_t index, const InfluenceTemplate<W, H> &influenceTemplate, float weight)
+BasicInfluenceMap<Storage> &BasicInfluenceMap<Storage>::addTemplateAtIndex(tileindex_t index, const InfluenceTemplate<W, H> &influenceTemplate, float weight)
 {
-  int deltaX = index % m_width - W / 2;
-  int deltaY = index / m_width - H / 2;
+  forEachBoxTile<W, H>(index, [&](float &value, unsigned x, unsigned y) { value += influenceTemplate.m_map[x + y * W] * weight; });
+  return *this;
+}
 
-  for (int i = 0; i < W * H; ++i) {
-    int x = i % W + deltaX;
-    int y = i / W + deltaY;
+template <class Storage>
+template <unsigned W, unsigned H>
+BasicInfluenceMap<Storage> &BasicInfluenceMap<Storage>::multiplyTemplateAtIndex(tileindex_t index, const InfluenceTemplate<W, H> &influenceTemplate, float weight)
+{
+  forEachBoxTile<W, H>(index, [&](float &value, unsigned x, unsigned y) { value *= influenceTemplate.m_map[x + y * W] * weight; });
+  return *this;
+}
 
-    if (x < 0 || x >= m_width || y < 0 || y >= m_height) continue;
+template <class Storage>
+template <class Mask>
+std::vector<tileindex_t> BasicInfluenceMap<Storage>::getNHighestPoints(int n, const Mask &mask) const
+{
+  top_points::TopPoints top{ n };
+  top.push(m_map.data(), 0, getSize(), mask);
+  std::vector<tileindex_t> points = top.getPoints();
+  points.resize(std::max(n, 0), static_cast<tileindex_t>(-1));
+  return points;
+}
 
-    m_map[getIndex(x, y)] *= influenceTemplate.m_map[i] * weight;
-  }
+// maps of the game, they only allocate the tables of their first region sum
+using InfluenceMap = BasicInfluenceMap<influence_storage::Inline<game_rules::MAX_MAP_SIZE * game_rules::MAX_MAP_SIZE>>;
+// same with the values on the heap, used to compare both
+using HeapInfluenceMap = BasicInfluenceMap<influence_storage::Heap>;
 
-  return *this;
-}
+extern template class BasicInfluenceMap<influence_storage::Inline<game_rules::MAX_MAP_SIZE * game_rules::MAX_MAP_SIZE>>;
+extern template class BasicInfluenceMap<influence_storage::Heap>;
 
 namespace influence_templates
 {
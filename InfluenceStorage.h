@@ -0,0 +1,69 @@
+#ifndef INFLUENCE_STORAGE_H
+#define INFLUENCE_STORAGE_H
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#include "AlignedAllocator.h"
+#include "InfluenceKernels.h"
+
+// Storage policies of BasicInfluenceMap, both are aligned for the kernels of InfluenceKernels.h.
+// resize() clears all values.
+namespace influence_storage
+{
+
+// values on the heap, for maps of any size
+class Heap
+{
+public:
+  float *data() { return m_values.data(); }
+  const float *data() const { return m_values.data(); }
+  size_t size() const { return m_values.size(); }
+  float &operator[](size_t index) { return m_values[index]; }
+  float operator[](size_t index) const { return m_values[index]; }
+
+  void resize(size_t count) { m_values.assign(count, 0.f); }
+
+private:
+  std::vector<float, AlignedAllocator<float, influence_kernels::ALIGNMENT>> m_values;
+};
+
+// values inside the map, creating or copying a map does not allocate
+// copies and moves only touch the values in use
+template <size_t Capacity>
+class Inline
+{
+public:
+  Inline() {} // the values are left uninitialized until resize()
+  Inline(const Inline &other) : m_size(other.m_size) { std::copy_n(other.data(), m_size, data()); }
+  Inline &operator=(const Inline &other)
+  {
+    m_size = other.m_size;
+    std::copy_n(other.data(), m_size, data());
+    return *this;
+  }
+
+  float *data() { return m_values.data(); }
+  const float *data() const { return m_values.data(); }
+  size_t size() const { return m_size; }
+  float &operator[](size_t index) { return m_values[index]; }
+  float operator[](size_t index) const { return m_values[index]; }
+
+  void resize(size_t count)
+  {
+    if (count > Capacity)
+      throw std::runtime_error("Map too large for an inline influence map");
+    m_size = count;
+    std::fill_n(data(), count, 0.f);
+  }
+
+private:
+  alignas(influence_kernels::ALIGNMENT) std::array<float, Capacity> m_values;
+  size_t m_size = 0;
+};
+
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef MAP_H
 #define MAP_H
 
+#include <algorithm>
 #include <vector>
 #include <utility>
 
@@ -36,6 +37,7 @@ public:
 		m_tiles.resize(width * height);
 	}
 
+	void clear() { std::ranges::fill(m_tiles, Tile{}); }
 	void rebuildResourceAdjencies();
 
 	int getWidth() const { return m_width; }
@@ -0,0 +1,491 @@
+// Micro benchmarks of the InfluenceMap operations, not part of the submission.
+//
+//   Microbench [-n iterations]
+//
+// Every operation is timed on the map sizes of the game for each instruction set the cpu
+// supports. The diffusion of propagateAllTimes is timed against the original bounds checked
+// loop, and the dense enemy paths against the trajectories they are now built from. The
+// queries of Pathing.cpp are timed with their heap allocations. Maps with inline storage are
+// timed against maps on the heap, the streaming top n of getNHighestPoints against the sort it
+// replaces, template stamping against the bounds checked loop it replaces, the similarity
+// matrix of squad detection against the map comparisons it replaces, the coverage queries on
+// tile sets against the scans of whole maps, the heading of enemy units against the scan of
+// their paths it replaced, the region sums of the summed-area tables against loops over the
+// regions, and the splatted resource stamps against a stamp per resource.
+// The reference implementations are in MicrobenchReferences.h, ReferenceCheck checks that the
+// results are the same.
+
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "EnemyTrajectory.h"
+#include "InfluenceDiffusion.h"
+#include "InfluenceKernels.h"
+#include "InfluenceMap.h"
+#include "MicrobenchReferences.h"
+#include "SimilarityMatrix.h"
+#include "TemplateSplat.h"
+#include "TileSet.h"
+
+namespace
+{
+
+using namespace microbench;
+
+// median of 'rounds' runs, in ns per call
+double timeOperation(const std::function<void()> &operation, int iterations, int rounds = 9)
+{
+  std::vector<double> samples;
+  for (int round = 0; round < rounds; round++) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++)
+      operation();
+    samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - t0).count() / static_cast<double>(iterations));
+  }
+  std::ranges::nth_element(samples, samples.begin() + rounds / 2);
+  return samples[rounds / 2];
+}
+
+struct Operation
+{
+  const char *name;
+  // runs the operation on 'map', 'other' is a second map of the same size
+  std::function<void(InfluenceMap &map, const InfluenceMap &other)> run;
+};
+
+// times the diffusion of 'batchSize' paths over 'n' sweeps
+void benchmarkDiffusion(int n, size_t batchSize, int iterations)
+{
+  std::printf("%-14s %5s %10s %10s %10s   (ns per map, %zu maps, %d sweeps)\n", "diffusion", "size", "checked", "padded", "batched", batchSize, n);
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    std::vector<InfluenceMap> maps;
+    std::vector<const InfluenceMap *> sources;
+    for (size_t i = 0; i < batchSize; i++)
+      maps.push_back(makeRandomMap(size, engine));
+    for (const InfluenceMap &map : maps)
+      sources.push_back(&map);
+    std::vector<InfluenceMap> results(batchSize);
+    InfluenceDiffusion diffusion;
+
+    double checkedNs = timeOperation([&] { for (const InfluenceMap &map : maps) propagateWithBoundsChecks(map, n); }, iterations / 10);
+    double paddedNs = timeOperation([&] { for (size_t i = 0; i < batchSize; i++) diffusion.propagate(maps[i], n, results[i]); }, iterations / 10);
+    double batchedNs = timeOperation([&] { diffusion.propagate(sources, n, results); }, iterations / 10);
+    std::printf("%-14s %5d %10.1f %6.1f x%.1f %6.1f x%.1f\n", "propagate", size,
+      checkedNs / batchSize, paddedNs / batchSize, checkedNs / paddedNs, batchedNs / batchSize, checkedNs / batchedNs);
+  }
+}
+
+// the dense decayed path updated every turn against the trajectory samples it is built from
+void benchmarkTrajectory(int turns, int pathLength)
+{
+  std::printf("%-14s %5s %10s %10s %10s   (ns, %d turns)\n", "trajectory", "size", "dense", "ring", "build", turns);
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    std::vector<tileindex_t> walk = makeRandomWalk(size, turns, engine);
+
+    InfluenceMap dense{ size, size };
+    EnemyTrajectory trajectory;
+    auto denseUpdate = [&](tileindex_t tile) {
+      dense.addMap(dense, -1.0f / pathLength);
+      dense.addValueAtIndex(tile, 1.f);
+    };
+    InfluenceMap built;
+
+    double denseNs = timeOperation([&] { for (tileindex_t tile : walk) denseUpdate(tile); }, 20) / turns;
+    double ringNs = timeOperation([&] { for (int turn = 0; turn < turns; turn++) trajectory.add(turn, walk[turn]); }, 20) / turns;
+    double buildNs = timeOperation([&] { built = trajectory.getPath(size, size, pathLength); }, 200);
+    std::printf("%-14s %5d %10.1f %6.1f x%.0f %10.1f\n", "update", size, denseNs, ringNs, denseNs / ringNs, buildNs);
+  }
+}
+
+// times 'query' and counts its heap allocations, returns the result of the last call
+std::vector<tileindex_t> benchmarkQuery(const LocationQuery &query, int iterations, double &ns, double &allocations)
+{
+  std::vector<tileindex_t> result = query.run();
+#ifdef BENCHMARKING
+  long long allocationCount = benchmark::allocationCount;
+  result = query.run();
+  allocations = static_cast<double>(benchmark::allocationCount - allocationCount);
+#else
+  allocations = 0;
+#endif
+  ns = timeOperation([&] { result = query.run(); }, iterations);
+  return result;
+}
+
+// the queries of pathing::getBestExpansionLocation and getMany*Locations on random maps, each
+// copies or sums maps into a working map before stamping it
+void benchmarkQueries(int iterations)
+{
+  using namespace influence_templates;
+  constexpr int n = 4;
+  std::printf("%-14s %5s %10s %10s   (ns and allocations per call)\n", "query", "size", "maps", "allocs");
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    const InfluenceMap cities = makeRandomMap(size, engine);
+    std::unordered_map<unitid_t, InfluenceMap> paths;
+    for (unitid_t id = 0; id < 8; id++)
+      paths.emplace(id, makeRandomMap(size, engine));
+    tileindex_t botTile = static_cast<tileindex_t>(engine() % (size * size));
+
+    const LocationQuery queries[] = {
+      { "expansion", [&] {
+          InfluenceMap workingMap{ cities };
+          workingMap.addTemplateAtIndex(botTile, AGENT_PROXIMITY, 3.f);
+          workingMap.addTemplateAtIndex(workingMap.getHighestPoint(), RESOURCE_PROXIMITY, 2.0f);
+          return workingMap.getNHighestPoints(n);
+        } },
+      { "blocking", [&] {
+          InfluenceMap workingMap{ size, size };
+          for (auto const &[_, val] : paths)
+            workingMap.addMap(val);
+          workingMap.addTemplateAtIndex(botTile, AGENT_PROXIMITY);
+          return workingMap.getNHighestPoints(n);
+        } },
+      { "bestExpansion", [&] {
+          InfluenceMap workingMap{ cities };
+          workingMap.addTemplateAtIndex(botTile, AGENT_PROXIMITY);
+          return std::vector<tileindex_t>{ workingMap.getHighestPoint() };
+        } },
+    };
+
+    for (const LocationQuery &query : queries) {
+      double ns, allocations;
+      benchmarkQuery(query, iterations / 10, ns, allocations);
+      std::printf("%-14s %5d %10.1f %10g\n", query.name, size, ns, allocations);
+    }
+  }
+}
+
+void benchmarkStorage(int iterations)
+{
+  std::printf("%-14s %5s %10s %10s %10s %10s   (ns and allocations per call)\n", "storage", "size", "heap", "allocs", "inline", "allocs");
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    const InfluenceMap cities = makeRandomMap(size, engine);
+    const InfluenceMap path = makeRandomMap(size, engine, -1.f, 1.f);
+    const HeapInfluenceMap heapCities = toHeapMap(cities), heapPath = toHeapMap(path);
+
+    std::vector<LocationQuery> heapQueries = makeTemporaryMapQueries(heapCities, heapPath, size);
+    std::vector<LocationQuery> inlineQueries = makeTemporaryMapQueries(cities, path, size);
+    for (size_t q = 0; q < heapQueries.size(); q++) {
+      double heapNs, heapAllocations, inlineNs, inlineAllocations;
+      benchmarkQuery(heapQueries[q], iterations / 10, heapNs, heapAllocations);
+      benchmarkQuery(inlineQueries[q], iterations / 10, inlineNs, inlineAllocations);
+      // the returned vector is one of the allocations
+      std::printf("%-14s %5d %10.1f %10g %6.1f x%.1f %10g\n", heapQueries[q].name, size, heapNs, heapAllocations - 1, inlineNs, heapNs / inlineNs, inlineAllocations - 1);
+    }
+  }
+}
+
+// on random maps, on maps with many equal values and with a mask rejecting a third of the tiles
+void benchmarkTopPoints(int iterations)
+{
+  constexpr int COUNTS[] = { 1, 4, 16, 100 };
+  std::printf("%-14s %5s %5s %10s %10s %10s %10s   (ns and allocations per call)\n", "top n", "size", "n", "sort", "allocs", "stream", "allocs");
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    const InfluenceMap random = makeRandomMap(size, engine);
+    InfluenceMap ties{ size, size };
+    for (int i = 0; i < ties.getSize(); i++)
+      ties.setValueAtIndex(i, static_cast<float>(engine() % 4));
+    std::vector<bool> empty(size * size);
+    for (size_t i = 0; i < empty.size(); i++)
+      empty[i] = engine() % 3 != 0;
+    auto isEmpty = [&empty](tileindex_t tile) { return empty[tile] == true; };
+    auto anyTile = [](tileindex_t) { return true; };
+
+    for (int n : COUNTS) {
+      const std::pair<LocationQuery, LocationQuery> queries[] = {
+        { { "random", [&] { return sortHighestPoints(random, n, anyTile); } },
+          { "random", [&] { return random.getNHighestPoints(n); } } },
+        { { "ties", [&] { return sortHighestPoints(ties, n, anyTile); } },
+          { "ties", [&] { return ties.getNHighestPoints(n); } } },
+        { { "masked", [&] { return sortHighestPoints(random, n, isEmpty); } },
+          { "masked", [&] { return random.getNHighestPoints(n, isEmpty); } } },
+      };
+      for (auto &[sortQuery, streamQuery] : queries) {
+        double sortNs, sortAllocations, streamNs, streamAllocations;
+        benchmarkQuery(sortQuery, iterations / 10, sortNs, sortAllocations);
+        benchmarkQuery(streamQuery, iterations / 10, streamNs, streamAllocations);
+        std::printf("%-14s %5d %5d %10.1f %10g %6.1f x%.1f %10g\n", sortQuery.name, size, n, sortNs, sortAllocations, streamNs, sortNs / streamNs, streamAllocations);
+      }
+    }
+  }
+}
+
+// stamps at every tile of the map, like computeInfluence does on resource tiles, so both
+// the interior and the clipped boxes are timed
+void benchmarkStamping(int iterations)
+{
+  std::printf("%-14s %5s %10s %10s   (ns per stamp)\n", "stamp", "size", "checked", "boxed");
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    const InfluenceMap input = makeRandomMap(size, engine);
+    const int tiles = size * size;
+    for (const Stamping &stamping : makeStampings(size, 3.f)) {
+      std::vector<float> values(input.getRow(0), input.getRow(0) + tiles);
+      InfluenceMap map = input;
+      double checkedNs = timeOperation([&] { stamping.checked(values); }, std::max(1, iterations / 100)) / tiles;
+      double boxedNs = timeOperation([&] { stamping.boxed(map); }, std::max(1, iterations / 100)) / tiles;
+      std::printf("%-14s %5d %10.1f %6.1f x%.1f\n", stamping.name, size, checkedNs, boxedNs, checkedNs / boxedNs);
+    }
+  }
+}
+
+// squad detection on 'unitCount' random walks: the first path blurred again and compared with
+// every other path, then the whole matrix, against one map comparison at a time
+void benchmarkSimilarity(int unitCount, int iterations)
+{
+  constexpr int propagationRadius = 2;
+  std::printf("%-14s %5s %5s %10s %10s   (ns per call, %d units)\n", "similarity", "size", "tol", "maps", "matrix", unitCount);
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    InfluenceDiffusion diffusion;
+    const std::vector<InfluenceMap> paths = makeSquadPaths(size, unitCount, propagationRadius, engine);
+
+    for (float tolerance : { 3.f, 4.f, 2.5f }) {
+      auto compareMaps = [&](size_t rows, std::vector<float> &similarities) {
+        similarities.clear();
+        for (size_t i = 0; i < rows; i++) {
+          InfluenceMap compared;
+          diffusion.propagate(paths[i], propagationRadius, compared);
+          for (size_t j = 0; j < paths.size(); j++)
+            similarities.push_back(similarityWithPowf(compared, paths[j], tolerance));
+        }
+      };
+      SimilarityMatrix matrix;
+      auto lookUp = [&](size_t rows, std::vector<float> &similarities) {
+        similarities.clear();
+        matrix.reset(paths, propagationRadius, tolerance);
+        for (size_t i = 0; i < rows; i++)
+          for (size_t j = 0; j < paths.size(); j++)
+            similarities.push_back(matrix.get(i, j));
+      };
+
+      for (auto [name, rows] : { std::pair{ "first row", size_t{ 1 } }, std::pair{ "all rows", paths.size() } }) {
+        std::vector<float> similarities;
+        double mapsNs = timeOperation([&] { compareMaps(rows, similarities); }, iterations / 100);
+        double matrixNs = timeOperation([&] { lookUp(rows, similarities); }, iterations / 100);
+        std::printf("%-14s %5d %5g %10.0f %6.0f x%.1f\n", name, size, tolerance, mapsNs, matrixNs, mapsNs / matrixNs);
+      }
+    }
+  }
+}
+
+// the coverage checks of squad detection: a propagated path against the tiles near an enemy
+// city cluster, the tile sets are built once per path and per cluster
+void benchmarkCoverage(int iterations)
+{
+  using namespace influence_templates;
+  std::printf("%-14s %5s %10s %10s %10s   (ns per call)\n", "coverage", "size", "scan", "tile set", "build");
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    InfluenceDiffusion diffusion;
+    EnemyTrajectory trajectory;
+    std::vector<tileindex_t> walk = makeRandomWalk(size, 60, engine);
+    for (size_t turn = 0; turn < walk.size(); turn++)
+      trajectory.add(turn, walk[turn]);
+    const InfluenceMap path = trajectory.getPath(size, size, 50);
+    InfluenceMap propagatedPath;
+    diffusion.propagate(path, 2, propagatedPath);
+    InfluenceMap ccMap{ size, size };
+    ccMap.addTemplateAtIndex(static_cast<tileindex_t>(engine() % (size * size)), ENEMY_CITY_CLUSTER_PROXIMITY);
+
+    const TileSet pathTiles = path.getPositiveTiles(), propagatedTiles = propagatedPath.getPositiveTiles();
+    const TileSet clusterTiles = ccMap.getPositiveTiles();
+
+    volatile size_t sink = 0;
+
+    double scanNs = timeOperation([&] { sink = coversTilesWithScan(propagatedPath, ccMap, 1000); }, iterations);
+    double setNs = timeOperation([&] { sink = propagatedTiles.coversTiles(clusterTiles, 1000); }, iterations);
+    double buildNs = timeOperation([&] { sink = propagatedPath.getPositiveTiles().size(); }, iterations);
+    std::printf("%-14s %5d %10.1f %6.1f x%.0f %10.1f\n", "coversTiles", size, scanNs, setNs, scanNs / setNs, buildNs);
+    scanNs = timeOperation([&] { sink = getValuedPointWithScan(path, sink + 7); }, iterations);
+    setNs = timeOperation([&] { sink = pathTiles.getNth((sink + 7) % pathTiles.size()); }, iterations);
+    std::printf("%-14s %5d %10.1f %6.1f x%.0f\n", "valuedPoint", size, scanNs, setNs, scanNs / setNs);
+  }
+}
+
+// InfluenceMap::approachesPoint before enemy headings, only timed: it divided by the length
+// of a zero vector and answered true for any path of more than 'step' tiles
+bool approachesPointWithScan(const InfluenceMap &path, int tileX, int tileY, int length, int step)
+{
+  std::vector<std::pair<tileindex_t, float>> distances;
+  for (int i = 0; i < path.getSize(); i++)
+    if (path.getValue(i) > 0)
+      distances.emplace_back(static_cast<tileindex_t>(i), path.getValue(i));
+  std::ranges::sort(distances, std::less{});
+  if (distances.size() <= static_cast<size_t>(step)) return false;
+  auto [x, y] = path.getCoord(distances.back().first);
+  double directionX = (tileX - x) / std::sqrt(0.), directionY = (tileY - y) / std::sqrt(directionX * directionX);
+  for (int i = 0; i < std::min(length, (int)distances.size() - step); i += step) {
+    double dx = distances[distances.size() - 1 - i].first - distances[distances.size() - 1 - i - step].first;
+    double dy = distances[distances.size() - 1 - i].second - distances[distances.size() - 1 - i - step].second;
+    double norm = std::sqrt(dx * dx + dy * dy);
+    if (std::abs(std::acos((directionX * dx + directionY * dy) / norm)) > 3.14159265359 / 4)
+      return false;
+  }
+  return true;
+}
+
+// the heading of a unit along a random walk, kept up to date with its trajectory
+void benchmarkHeading(int turns, int window)
+{
+  const float minCosine = std::cos(3.14159265359f / 4);
+  std::printf("%-14s %5s %10s %10s %10s   (ns, %d turns)\n", "heading", "size", "scan", "heading", "update", turns);
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    std::vector<tileindex_t> walk = makeRandomWalk(size, turns, engine);
+    EnemyTrajectory trajectory;
+    for (int turn = 0; turn < turns; turn++) {
+      trajectory.add(turn, walk[turn]);
+      trajectory.updateHeading(size, window);
+    }
+
+    const InfluenceMap path = trajectory.getPath(size, size, 50);
+    volatile bool sink = false;
+    double scanNs = timeOperation([&] { sink = approachesPointWithScan(path, size / 2, size / 2, 50, window); }, 200);
+    double headingNs = timeOperation([&] { sink = trajectory.getHeading().approaches(size / 2, size / 2, minCosine); }, 20000);
+    double updateNs = timeOperation([&] { trajectory.updateHeading(size, window); }, 20000);
+    std::printf("%-14s %5d %10.1f %6.1f x%.0f %10.1f\n", "approaches", size, scanNs, headingNs, scanNs / headingNs, updateNs);
+  }
+}
+
+// diamonds around every tile on integer maps like the neighbour counts of pathing, and the
+// rebuild of the tables after a change of the map
+void benchmarkRegionSums(int iterations)
+{
+  std::printf("%-14s %5s %5s %10s %10s %10s   (ns per tile, build per map)\n", "region sums", "size", "r", "loop", "table", "build");
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    InfluenceMap integers{ size, size };
+    for (int i = 0; i < integers.getSize(); i++)
+      integers.setValueAtIndex(i, static_cast<float>(engine() % 4 == 0 ? engine() % 21 : 0));
+
+    volatile float sink = 0;
+    for (int radius : { 1, 4 }) {
+      double loopNs = timeOperation([&] { for (int tile = 0; tile < size * size; tile++) sink = static_cast<float>(sumDiamondWithLoop(integers, tile % size, tile / size, radius)); }, iterations / 100) / (size * size);
+      double tableNs = timeOperation([&] { for (int tile = 0; tile < size * size; tile++) sink = integers.sumDiamond(tile % size, tile / size, radius); }, iterations / 100) / (size * size);
+      double buildNs = timeOperation([&] { integers.addValueAtIndex(0, 0.f); sink = integers.sumDiamond(0, 0, 0); }, iterations / 10);
+      std::printf("%-14s %5d %5d %10.1f %6.1f x%.1f %10.1f\n", "sumDiamond", size, radius, loopNs, tableNs, loopNs / tableNs, buildNs);
+    }
+  }
+}
+
+// the stamps of computeInfluence on a given share of the tiles, one by one and splatted, and
+// the way computeInfluence picks (see TemplateSplat::shouldConvolve)
+void benchmarkSplat(int iterations)
+{
+  using namespace influence_templates;
+  std::printf("%-14s %5s %5s %10s %10s %10s   (ns per map)\n", "splat", "size", "tiles", "stamps", "splat", "picked");
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    for (int percent : { 5, 20, 40, 100 }) {
+      std::vector<std::pair<tileindex_t, float>> stamps, randomStamps;
+      makeSplatStamps(size, percent, engine, stamps, randomStamps);
+
+      // timed on the resources map, like computeInfluence
+      InfluenceMap resources{ size, size };
+      TemplateSplat splatted{ size, size };
+      double stampsNs = timeOperation([&] {
+        for (auto [tile, weight] : stamps)
+          resources.addTemplateAtIndex(tile, RESOURCE_PROXIMITY, weight);
+      }, iterations / 10);
+      double splatNs = timeOperation([&] {
+        splatted.clear();
+        for (auto [tile, weight] : stamps)
+          splatted.add(tile, weight);
+        splatted.addTo(resources, RESOURCE_PROXIMITY);
+      }, iterations / 10);
+      bool convolve = TemplateSplat::shouldConvolve(RESOURCE_PROXIMITY, stamps.size(), size, size);
+      std::printf("%-14s %5d %5zu %10.1f %6.1f x%.1f %10s\n", "resources", size, stamps.size(), stampsNs, splatNs, stampsNs / splatNs, convolve ? "splat" : "stamps");
+    }
+  }
+}
+}
+
+int main(int argc, char **argv)
+{
+  int iterations = 20000;
+  if (argc > 2 && std::string(argv[1]) == "-n")
+    iterations = std::max(1, std::stoi(argv[2]));
+
+  const std::vector<InstructionSet> instructionSets = getSupportedInstructionSets();
+
+  // results are kept in a volatile so that nothing is optimized away
+  volatile tileindex_t sink = 0;
+  const Operation operations[] = {
+    { "clear",       [](InfluenceMap &map, const InfluenceMap &) { map.clear(); } },
+    { "addMap",      [](InfluenceMap &map, const InfluenceMap &other) { map.addMap(other, .5f); } },
+    { "multiplyMap", [](InfluenceMap &map, const InfluenceMap &other) { map.multiplyMap(other, 1.f); } },
+    { "flip",        [](InfluenceMap &map, const InfluenceMap &) { map.flip(); } },
+    { "normalize",   [](InfluenceMap &map, const InfluenceMap &) { map.normalize(); } },
+    { "highestPoint",[&sink](InfluenceMap &map, const InfluenceMap &) { sink = map.getHighestPoint(); } },
+  };
+
+  std::printf("%-14s %5s", "operation", "size");
+  for (InstructionSet instructionSet : instructionSets)
+    std::printf(" %10s", influence_kernels::getName(instructionSet));
+  std::printf("   (ns per call, speed-up over scalar)\n");
+
+  for (const Operation &operation : operations) {
+    for (int size : MAP_SIZES) {
+      std::mt19937 engine{ static_cast<unsigned>(size) };
+      const InfluenceMap input = makeRandomMap(size, engine);
+      // multiplying by ones keeps the values stable over the iterations
+      InfluenceMap other = std::string(operation.name) == "multiplyMap" ? InfluenceMap{ size, size } : makeRandomMap(size, engine);
+      if (std::string(operation.name) == "multiplyMap")
+        other.flip();
+
+      std::printf("%-14s %5d", operation.name, size);
+      double scalarNs = 0;
+      for (InstructionSet instructionSet : instructionSets) {
+        influence_kernels::setInstructionSet(instructionSet);
+        InfluenceMap map = input;
+        double ns = timeOperation([&] { operation.run(map, other); }, iterations);
+        if (instructionSet == InstructionSet::SCALAR) {
+          scalarNs = ns;
+          std::printf(" %10.1f", ns);
+        } else {
+          std::printf(" %6.1f x%.1f", ns, scalarNs / ns);
+        }
+      }
+      std::printf("\n");
+    }
+  }
+  influence_kernels::setInstructionSet(influence_kernels::getBestInstructionSet());
+
+  std::printf("\n");
+  benchmarkDiffusion(2, 8, iterations);
+  std::printf("\n");
+  benchmarkTrajectory(360, 50);
+  std::printf("\n");
+  benchmarkQueries(iterations);
+  std::printf("\n");
+  benchmarkStorage(iterations);
+  std::printf("\n");
+  benchmarkTopPoints(iterations);
+  std::printf("\n");
+  benchmarkStamping(iterations);
+  std::printf("\n");
+  benchmarkSimilarity(12, iterations);
+  std::printf("\n");
+  benchmarkCoverage(iterations);
+  std::printf("\n");
+  benchmarkHeading(360, 5);
+  std::printf("\n");
+  benchmarkRegionSums(iterations);
+  std::printf("\n");
+  benchmarkSplat(iterations);
+
+  return 0;
+}
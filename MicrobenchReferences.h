@@ -0,0 +1,279 @@
+#ifndef MICROBENCH_REFERENCES_H
+#define MICROBENCH_REFERENCES_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "EnemyTrajectory.h"
+#include "GameRules.h"
+#include "InfluenceDiffusion.h"
+#include "InfluenceKernels.h"
+#include "InfluenceMap.h"
+
+// The InfluenceMap code as it was before it was optimized and the random inputs both versions
+// run on, not part of the submission. Microbench times the two versions, ReferenceCheck checks
+// that they give the same results.
+namespace microbench
+{
+
+using influence_kernels::InstructionSet;
+
+constexpr int MAP_SIZES[] = { 12, 16, 24, 32 };
+
+inline std::vector<InstructionSet> getSupportedInstructionSets()
+{
+  std::vector<InstructionSet> instructionSets{ InstructionSet::SCALAR };
+  if (influence_kernels::getBestInstructionSet() >= InstructionSet::SSE2) instructionSets.push_back(InstructionSet::SSE2);
+  if (influence_kernels::getBestInstructionSet() >= InstructionSet::AVX2) instructionSets.push_back(InstructionSet::AVX2);
+  return instructionSets;
+}
+
+inline InfluenceMap makeRandomMap(int size, std::mt19937 &engine, float low = 0.f, float high = 1.f)
+{
+  std::uniform_real_distribution<float> distribution{ low, high };
+  InfluenceMap map{ size, size };
+  for (int i = 0; i < map.getSize(); i++)
+    map.setValueAtIndex(i, distribution(engine));
+  return map;
+}
+
+// tiles of a unit moving at random from the center of the map
+inline std::vector<tileindex_t> makeRandomWalk(int size, int turns, std::mt19937 &engine)
+{
+  std::vector<tileindex_t> walk;
+  int x = size / 2, y = size / 2;
+  for (int turn = 0; turn < turns; turn++) {
+    int step = static_cast<int>(engine() % 5);
+    x = std::clamp(x + (step == 1) - (step == 2), 0, size - 1);
+    y = std::clamp(y + (step == 3) - (step == 4), 0, size - 1);
+    walk.push_back(static_cast<tileindex_t>(x + y * size));
+  }
+  return walk;
+}
+
+// the normalized paths of 'unitCount' random walks compared by squad detection
+inline std::vector<InfluenceMap> makeSquadPaths(int size, int unitCount, int propagationRadius, std::mt19937 &engine)
+{
+  InfluenceDiffusion diffusion;
+  std::vector<InfluenceMap> paths;
+  for (int unit = 0; unit < unitCount; unit++) {
+    EnemyTrajectory trajectory;
+    std::vector<tileindex_t> walk = makeRandomWalk(size, 60, engine);
+    for (size_t turn = 0; turn < walk.size(); turn++)
+      trajectory.add(turn, walk[turn]);
+    InfluenceMap &path = paths.emplace_back();
+    diffusion.propagate(trajectory.getPath(size, size, 50), propagationRadius, path);
+    path.normalize();
+  }
+  return paths;
+}
+
+// stamps of resource amounts on 'percent' of the tiles, and stamps of random weights on the same
+// tiles
+inline void makeSplatStamps(int size, int percent, std::mt19937 &engine, std::vector<std::pair<tileindex_t, float>> &stamps, std::vector<std::pair<tileindex_t, float>> &randomStamps)
+{
+  for (int i = 0; i < size * size; i++) {
+    if (static_cast<int>(engine() % 100) >= percent) continue;
+    stamps.emplace_back(static_cast<tileindex_t>(i), static_cast<float>(engine() % 500 * game_rules::COLLECT_RATE_WOOD));
+    randomStamps.emplace_back(static_cast<tileindex_t>(i), std::uniform_real_distribution<float>{ -10.f, 10.f }(engine));
+  }
+}
+
+inline bool sameValues(const InfluenceMap &a, const InfluenceMap &b)
+{
+  for (int i = 0; i < a.getSize(); i++)
+    if (a.getValue(i) != b.getValue(i)) return false;
+  return true;
+}
+
+struct LocationQuery
+{
+  const char *name;
+  std::function<std::vector<tileindex_t>()> run;
+};
+
+// the temporary maps of Pathing.cpp and CommandChain.cpp, with a given storage
+template <class Map>
+std::vector<LocationQuery> makeTemporaryMapQueries(const Map &cities, const Map &path, int size)
+{
+  using namespace influence_templates;
+  tileindex_t tile = static_cast<tileindex_t>(size * size / 3);
+  return {
+    { "workingMap", [&cities, tile] {
+        Map workingMap{ cities };
+        workingMap.addTemplateAtIndex(tile, AGENT_PROXIMITY);
+        return std::vector<tileindex_t>{ workingMap.getHighestPoint() };
+      } },
+    { "ccMap", [&path, tile, size] {
+        Map ccMap{ size, size };
+        ccMap.addTemplateAtIndex(tile, ENEMY_CITY_CLUSTER_PROXIMITY);
+        return std::vector<tileindex_t>{ static_cast<tileindex_t>(path.coversTiles(ccMap, 3)) };
+      } },
+    { "startCheck", [&cities, &path] {
+        Map startCheck{ path };
+        startCheck.multiplyMap(cities);
+        return std::vector<tileindex_t>{ startCheck.getHighestPoint() };
+      } },
+  };
+}
+
+// copies the values of 'map' in a map with the storage of the original InfluenceMap
+inline HeapInfluenceMap toHeapMap(const InfluenceMap &map)
+{
+  HeapInfluenceMap heapMap{ map.getWidth(), map.getHeight() };
+  for (int i = 0; i < map.getSize(); i++)
+    heapMap.setValueAtIndex(i, map.getValue(i));
+  return heapMap;
+}
+
+// propagateAllTimes before InfluenceDiffusion
+inline InfluenceMap propagateWithBoundsChecks(const InfluenceMap &map, int n)
+{
+  int width = map.getWidth(), height = map.getHeight();
+  InfluenceMap i1{ map };
+  InfluenceMap i2{ width, height };
+  for (int k = 0; k < n; k++) {
+    for (int i = 0; i < height; i++) {
+      for (int j = 0; j < width; j++) {
+        float value = i1.getValue(j, i);
+        if (i < height - 1) value += i1.getValue(j, i + 1) / 2.f;
+        if (i > 0)          value += i1.getValue(j, i - 1) / 2.f;
+        if (j < width - 1)  value += i1.getValue(j + 1, i) / 2.f;
+        if (j > 0)          value += i1.getValue(j - 1, i) / 2.f;
+        i2.setValueAtIndex(i2.getIndex(j, i), value);
+      }
+    }
+    std::swap(i1, i2);
+  }
+  return i1;
+}
+
+// getNHighestPoints before TopPoints.h, every tile sorted by decreasing (value, tile)
+inline std::vector<tileindex_t> sortHighestPoints(const InfluenceMap &map, int n, const std::function<bool(tileindex_t)> &mask)
+{
+  std::vector<std::pair<float, tileindex_t>> indexedVec;
+  indexedVec.reserve(map.getSize());
+  for (tileindex_t i = 0; i < map.getSize(); ++i) {
+    if (mask(i))
+      indexedVec.emplace_back(map.getValue(i), i);
+  }
+  size_t count = std::min(indexedVec.size(), static_cast<size_t>(n));
+  std::ranges::partial_sort(indexedVec, indexedVec.begin() + count, std::greater());
+  std::vector<tileindex_t> resultIndices(n, static_cast<tileindex_t>(-1));
+  for (size_t i = 0; i < count; ++i)
+    resultIndices[i] = indexedVec[i].second;
+  return resultIndices;
+}
+
+// addTemplateAtIndex before the compile time boxes, bounds checked per tile, on the values of
+// a width * height map
+template <unsigned W, unsigned H>
+void addTemplateWithBoundsChecks(std::vector<float> &values, int width, int height, tileindex_t index, const InfluenceTemplate<W, H> &influenceTemplate, float weight)
+{
+  int deltaX = index % width - static_cast<int>(W / 2);
+  int deltaY = index / width - static_cast<int>(H / 2);
+  for (unsigned i = 0; i < W * H; ++i) {
+    int x = static_cast<int>(i % W) + deltaX;
+    int y = static_cast<int>(i / W) + deltaY;
+    if (x < 0 || x >= width || y < 0 || y >= height) continue;
+    values[x + y * width] += influenceTemplate.getValue(i % W, i / W) * weight;
+  }
+}
+
+// propagate before the distance kernels, through a function pointer
+inline void propagateWithFunctionPointer(std::vector<float> &values, int width, int height, tileindex_t index, float initialInfluence, float (*propagationFunction)(float, float), int range)
+{
+  int x1 = index % width, y1 = index / width;
+  for (int y2 = std::max(0, y1 - range); y2 < std::min(height, y1 + range + 1); ++y2) {
+    for (int x2 = std::max(0, x1 - range); x2 < std::min(width, x1 + range + 1); ++x2)
+      values[x2 + y2 * width] += propagationFunction(initialInfluence, static_cast<float>(std::abs(x1 - x2) + std::abs(y1 - y2)));
+  }
+}
+
+inline float linearFalloff(float influence, float distance) { return influence * (1 - distance / 4.0f); }
+
+// the stamps of computeInfluence at every tile of the map, with the bounds checked loops and
+// with the compile time boxes, so both the interior and the clipped boxes are run
+struct Stamping
+{
+  const char *name;
+  std::function<void(std::vector<float> &)> checked;
+  std::function<void(InfluenceMap &)> boxed;
+};
+
+inline std::vector<Stamping> makeStampings(int size, float weight)
+{
+  using namespace influence_templates;
+  const int tiles = size * size;
+  return {
+    { "resource",
+      [=](std::vector<float> &values) { for (int i = 0; i < tiles; i++) addTemplateWithBoundsChecks(values, size, size, i, RESOURCE_PROXIMITY, weight); },
+      [=](InfluenceMap &map) { for (int i = 0; i < tiles; i++) map.addTemplateAtIndex(i, RESOURCE_PROXIMITY, weight); } },
+    { "agent",
+      [=](std::vector<float> &values) { for (int i = 0; i < tiles; i++) addTemplateWithBoundsChecks(values, size, size, i, AGENT_PROXIMITY, weight); },
+      [=](InfluenceMap &map) { for (int i = 0; i < tiles; i++) map.addTemplateAtIndex(i, AGENT_PROXIMITY, weight); } },
+    { "propagate",
+      [=](std::vector<float> &values) { for (int i = 0; i < tiles; i++) propagateWithFunctionPointer(values, size, size, i, weight, linearFalloff, 2); },
+      [=](InfluenceMap &map) { for (int i = 0; i < tiles; i++) map.propagate<2, linearFalloff>(i, weight); } },
+  };
+}
+
+// InfluenceMap::getSimilarity before the similarity kernel
+inline float similarityWithPowf(const InfluenceMap &a, const InfluenceMap &b, float similarityTolerance)
+{
+  float similarity = 0;
+  float count = 0;
+  for (int i = 0; i < a.getSize(); i++) {
+    if (a.getValue(i) == 0 && b.getValue(i) == 0) continue;
+    count++;
+    similarity += std::max(0.f, 1 - std::pow(std::abs(a.getValue(i) - b.getValue(i)), similarityTolerance));
+  }
+  return similarity * 100.f / count;
+}
+
+// InfluenceMap::coversTiles and getRandomValuedPoint before tile sets
+inline bool coversTilesWithScan(const InfluenceMap &path, const InfluenceMap &mapToCover, int tilesNeeded)
+{
+  int covered = 0;
+  for (int i = 0; i < path.getSize(); i++) {
+    if (mapToCover.getValue(i) > 0 && path.getValue(i) > 0 && ++covered >= tilesNeeded)
+      return true;
+  }
+  return false;
+}
+
+inline tileindex_t getValuedPointWithScan(const InfluenceMap &path, size_t random)
+{
+  std::vector<tileindex_t> valuedPoints;
+  for (int i = 0; i < path.getSize(); i++)
+    if (path.getValue(i) > 0)
+      valuedPoints.push_back(static_cast<tileindex_t>(i));
+  return valuedPoints[random % valuedPoints.size()];
+}
+
+inline double sumDiamondWithLoop(const InfluenceMap &map, int x, int y, int radius)
+{
+  double sum = 0;
+  for (int ty = std::max(y - radius, 0); ty <= std::min(y + radius, map.getHeight() - 1); ty++) {
+    int reach = radius - std::abs(ty - y);
+    for (int tx = std::max(x - reach, 0); tx <= std::min(x + reach, map.getWidth() - 1); tx++)
+      sum += map.getValue(tx, ty);
+  }
+  return sum;
+}
+
+inline double sumRectWithLoop(const InfluenceMap &map, int x0, int y0, int x1, int y1)
+{
+  double sum = 0;
+  for (int y = std::max(y0, 0); y <= std::min(y1, map.getHeight() - 1); y++)
+    for (int x = std::max(x0, 0); x <= std::min(x1, map.getWidth() - 1); x++)
+      sum += map.getValue(x, y);
+  return sum;
+}
+
+}
+
+#endif
@@ -11,7 +11,7 @@
 namespace pathing
 {
 
-bool checkPathValidity(const std::vector<tileindex_t> &path, const Map &map, const std::vector<tileindex_t> &botPositions, size_t moveAheadCount)
+bool checkPathValidity(const std::vector<tileindex_t> &path, const Map &map, const TileOccupancy &occupancy, size_t moveAheadCount)
 {
   for (size_t i = 0; i < std::min(moveAheadCount, path.size()); i++) {
     tileindex_t nextTileIdx = path[path.size() - i - 1];
@@ -19,7 +19,7 @@ bool checkPathValidity(const std::vector<tileindex_t> &path, const Map &map, con
     if (nextTile.getType() == TileType::ENEMY_CITY)
       return false; // a new city has been built
     if (nextTile.getType() != TileType::ALLY_CITY) {
-      if (std::ranges::find(botPositions, nextTileIdx) != botPositions.end())
+      if (occupancy.isOccupied(nextTileIdx))
         return false; // a bot is right in front
     }
   }
@@ -33,7 +33,7 @@ tileindex_t getResourceFetchingLocation(const Bot* bot, const GameState *gameSta
   const int neededResources = game_rules::WORKER_CARRY_CAPACITY - (bot->getCoalAmount() + bot->getWoodAmount() + bot->getUraniumAmount());
 
   const Map *map = &gameState->map;
-  size_t currentResearchPoints = gameState->playerResearchPoints[Player::ALLY];
+  const InfluenceMap &collectable = gameState->collectableResources;
 
   tileindex_t botTile = map->getTileIndex(*bot);
 
@@ -42,25 +42,9 @@ tileindex_t getResourceFetchingLocation(const Bot* bot, const GameState *gameSta
   for (tileindex_t i = 0; i < map->getMapSize(); i++) {
     if(map->tileAt(i).getType() == TileType::ALLY_CITY || map->tileAt(i).getType() == TileType::ENEMY_CITY)
       continue;
-    int neighborResources = 0;
-    std::vector<tileindex_t> neighbors = map->getValidNeighbours(i, PathFlags::NONE);
-    for (tileindex_t j : neighbors) {
-      if (map->tileAt(j).getType() == TileType::RESOURCE) {
-        switch (map->tileAt(j).getResourceType()) {
-        case kit::ResourceType::wood:
-          neighborResources += std::min((int)game_rules::COLLECT_RATE_WOOD, map->tileAt(j).getResourceAmount());
-          break;
-        case kit::ResourceType::coal:
-          if(currentResearchPoints >= game_rules::MIN_RESEARCH_COAL)
-            neighborResources += std::min((int)game_rules::COLLECT_RATE_COAL, map->tileAt(j).getResourceAmount());
-          break;
-        case kit::ResourceType::uranium:
-          if(currentResearchPoints >= game_rules::MIN_RESEARCH_URANIUM)
-            neighborResources += std::min((int)game_rules::COLLECT_RATE_URANIUM, map->tileAt(j).getResourceAmount());
-          break;
-        }
-      }
-    }
+    // the 4 neighbours are the diamond of radius 1 without the tile itself
+    auto [x, y] = map->getTilePosition(i);
+    int neighborResources = static_cast<int>(collectable.sumDiamond(x, y, 1) - collectable.getValue(i));
     if (neighborResources == 0)
       continue;
     float tileScore = 
@@ -87,13 +71,8 @@ tileindex_t getBestCityBuildingLocation(const tileindex_t botTile, const GameSta
   {
     if(map->tileAt(i).getType() != TileType::EMPTY) continue;
     std::pair<int, int> coords = map->getTilePosition(i);
-    size_t neighborCities = 0;
-    std::vector<tileindex_t> neighbors = map->getValidNeighbours(i, PathFlags::NONE);
-    for (tileindex_t j : neighbors)
-    {
-      if (map->tileAt(j).getType() == TileType::ALLY_CITY)
-        neighborCities++;
-    }
+    // the tile is empty, its diamond of radius 1 only counts its neighbours
+    size_t neighborCities = static_cast<size_t>(gameState->allyCityTiles.sumDiamond(coords.first, coords.second, 1));
     auto botCoords = gameState->map.getTilePosition(botTile);
     float tileScore = 
       ADJACENT_CITIES_WEIGHT * neighborCities +
@@ -138,17 +117,12 @@ tileindex_t getBestCityFeedingLocation(const tileindex_t botTile, const GameStat
 tileindex_t getBestBlockingPathLocation(const tileindex_t botTile, const GameState* gameState)
 {
   // TODO: check if the highestpoint can be ennemy city
-  InfluenceMap workingMap{ gameState->map.getWidth(), gameState->map.getHeight() };
-
-  for (auto const& [_, val] : gameState->ennemyPath)
-    workingMap.addMap(val);
-
+  InfluenceMap workingMap{ gameState->ennemyPathInfluence };
   workingMap.addTemplateAtIndex(botTile, influence_templates::AGENT_PROXIMITY);
-
   return workingMap.getHighestPoint();
 }
 
-tileindex_t getBestNightTimeLocation(const tileindex_t botTile, const GameState *gameState, const std::vector<tileindex_t> &occupiedTiles)
+tileindex_t getBestNightTimeLocation(const tileindex_t botTile, const GameState *gameState)
 {
   /*
    * At night, agents try to reach the nearest city to avoid dying
@@ -175,7 +149,7 @@ tileindex_t getBestNightTimeLocation(const tileindex_t botTile, const GameState
     bool isCity = map->tileAt(i).getType() == TileType::ALLY_CITY;
     if (!isCity && !hasAdjacentResources) continue;
     size_t dist = map->distanceBetween(i, botTile);
-    bool isTileOccupied = std::ranges::count(occupiedTiles, i) - (i == botTile) > 0;
+    bool isTileOccupied = gameState->occupancy.getNonCityUnitCount(i) - (i == botTile) > 0;
     float tileScore = 0
       + isCityFactor * isCity
       + distanceWeight * (float)dist
@@ -213,13 +187,15 @@ std::vector<tileindex_t> getManyCityBuildingLocations(const tileindex_t botTile,
     const Map *map = &gameState->map;
     for (tileindex_t i = 0; i < map->getMapSize(); i++) {
         if (map->tileAt(i).getType() != TileType::EMPTY) continue;
-        size_t neighborCities = 0;
+        std::pair<int, int> coords = map->getTilePosition(i);
+        // the tile is empty, its diamond of radius 1 only counts its neighbours
+        size_t neighborCities = static_cast<size_t>(gameState->allyCityTiles.sumDiamond(coords.first, coords.second, 1));
+        // the best neighbouring resource, a max that no region sum gives
         float resourceScore = 0.f;
-        std::vector<tileindex_t> neighbors = map->getValidNeighbours(i, PathFlags::NONE);
-        for (tileindex_t j : neighbors) {
-            if (map->tileAt(j).getType() == TileType::ALLY_CITY) {
-                neighborCities++;
-            } else if (map->tileAt(j).getType() == TileType::RESOURCE) {
+        for (kit::DIRECTIONS direction : { kit::DIRECTIONS::NORTH, kit::DIRECTIONS::EAST, kit::DIRECTIONS::SOUTH, kit::DIRECTIONS::WEST }) {
+            if (!map->isValidNeighbour(i, direction)) continue;
+            tileindex_t j = map->getTileNeighbour(i, direction);
+            if (map->tileAt(j).getType() == TileType::RESOURCE) {
                 kit::ResourceType rt = map->tileAt(j).getResourceType();
                 float rs = 1;
                 switch (rt) {
@@ -258,11 +234,7 @@ std::vector<tileindex_t> getManyExpansionLocations(const tileindex_t botTile, co
 std::vector<tileindex_t> getManyBlockingPathLocations(const tileindex_t botTile, const GameState* gameState, int n)
 {
   // TODO: check if the highestpoint can be ennemy city
-  InfluenceMap workingMap{ gameState->map.getWidth(), gameState->map.getHeight() };
-
-  for (auto const& [_, val] : gameState->ennemyPath)
-    workingMap.addMap(val);
-
+  InfluenceMap workingMap{ gameState->ennemyPathInfluence };
   workingMap.addTemplateAtIndex(botTile, influence_templates::AGENT_PROXIMITY);
 
   return workingMap.getNHighestPoints(n);
@@ -0,0 +1,401 @@
+// Correctness checks of the optimized InfluenceMap code, not part of the submission.
+//
+//   ReferenceCheck
+//
+// Every check runs once on the map sizes of the game, without timing (see Microbench for the
+// numbers), and exits with 1 if a result differs. The element-wise operations and the kernels
+// behind the top n, the positive tiles and the similarities are compared with the scalar
+// implementation for each instruction set the cpu supports. The diffusion is compared with
+// the original bounds checked loop, the dense enemy paths with the trajectories they are now
+// built from, maps with inline storage with maps on the heap, the streaming top n with the
+// sort it replaces, template stamping with the bounds checked loop it replaces, the similarity
+// matrix with the map comparisons it replaces, the coverage queries on tile sets with the scans
+// of whole maps, the heading of enemy units with the angle to every tile, the region sums of
+// the summed-area tables with loops over the regions, and the splatted resource stamps with a
+// stamp per resource.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "EnemyTrajectory.h"
+#include "InfluenceDiffusion.h"
+#include "InfluenceKernels.h"
+#include "InfluenceMap.h"
+#include "MicrobenchReferences.h"
+#include "SimilarityMatrix.h"
+#include "TemplateSplat.h"
+#include "TileSet.h"
+
+namespace
+{
+
+using namespace microbench;
+
+struct Operation
+{
+  const char *name;
+  // runs the operation on 'map', 'other' is a second map of the same size
+  void (*run)(InfluenceMap &map, const InfluenceMap &other);
+};
+
+// every instruction set against the scalar implementation, 'other' is random for every operation
+bool checkOperations()
+{
+  const Operation operations[] = {
+    { "clear",       [](InfluenceMap &map, const InfluenceMap &) { map.clear(); } },
+    { "addMap",      [](InfluenceMap &map, const InfluenceMap &other) { map.addMap(other, .5f); } },
+    { "multiplyMap", [](InfluenceMap &map, const InfluenceMap &other) { map.multiplyMap(other, 1.5f); } },
+    { "flip",        [](InfluenceMap &map, const InfluenceMap &) { map.flip(); } },
+    { "normalize",   [](InfluenceMap &map, const InfluenceMap &) { map.normalize(); } },
+    { "highestPoint",[](InfluenceMap &map, const InfluenceMap &) { map.setValueAtIndex(map.getHighestPoint(), -1.f); } },
+  };
+
+  bool allMatch = true;
+  for (const Operation &operation : operations) {
+    for (int size : MAP_SIZES) {
+      std::mt19937 engine{ static_cast<unsigned>(size) };
+      const InfluenceMap input = makeRandomMap(size, engine);
+      const InfluenceMap other = makeRandomMap(size, engine);
+      InfluenceMap reference;
+      for (InstructionSet instructionSet : getSupportedInstructionSets()) {
+        influence_kernels::setInstructionSet(instructionSet);
+        InfluenceMap checked = input;
+        operation.run(checked, other);
+        if (instructionSet == InstructionSet::SCALAR)
+          reference = checked;
+        else if (!sameValues(reference, checked) || checked.getHighestPoint() != reference.getHighestPoint())
+          allMatch = false;
+      }
+    }
+  }
+  influence_kernels::setInstructionSet(influence_kernels::getBestInstructionSet());
+  return allMatch;
+}
+
+// 'batchSize' paths diffused one by one and in a batch over 'n' sweeps
+bool checkDiffusion(int n, size_t batchSize)
+{
+  bool allMatch = true;
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    std::vector<InfluenceMap> maps;
+    std::vector<const InfluenceMap *> sources;
+    for (size_t i = 0; i < batchSize; i++)
+      maps.push_back(makeRandomMap(size, engine));
+    for (const InfluenceMap &map : maps)
+      sources.push_back(&map);
+    std::vector<InfluenceMap> results(batchSize);
+    InfluenceDiffusion diffusion;
+
+    diffusion.propagate(sources, n, results);
+    for (size_t i = 0; i < batchSize; i++) {
+      InfluenceMap single;
+      diffusion.propagate(maps[i], n, single);
+      InfluenceMap reference = propagateWithBoundsChecks(maps[i], n);
+      allMatch &= sameValues(reference, results[i]) && sameValues(reference, single);
+    }
+  }
+  return allMatch;
+}
+
+// the dense decayed path updated every turn against the path built from the trajectory samples:
+// same tiles visited, values equal up to rounding
+bool checkTrajectory(int turns, int pathLength)
+{
+  bool allMatch = true;
+  float maxError = 0;
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    std::vector<tileindex_t> walk = makeRandomWalk(size, turns, engine);
+    InfluenceMap dense{ size, size };
+    EnemyTrajectory trajectory;
+    for (int turn = 0; turn < turns; turn++) {
+      dense.addMap(dense, -1.0f / pathLength);
+      dense.addValueAtIndex(walk[turn], 1.f);
+      trajectory.add(turn, walk[turn]);
+    }
+
+    InfluenceMap built = trajectory.getPath(size, size, pathLength);
+    for (int i = 0; i < dense.getSize(); i++) {
+      allMatch &= (dense.getValue(i) > 0) == (built.getValue(i) > 0);
+      maxError = std::max(maxError, std::abs(built.getValue(i) - dense.getValue(i)) / (1.f + dense.getValue(i)));
+    }
+  }
+  std::printf("%-14s max error %g\n", "trajectory", maxError);
+  return allMatch && maxError < 1e-4f;
+}
+
+bool checkStorage()
+{
+  bool allMatch = true;
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    const InfluenceMap cities = makeRandomMap(size, engine);
+    const InfluenceMap path = makeRandomMap(size, engine, -1.f, 1.f);
+    const HeapInfluenceMap heapCities = toHeapMap(cities), heapPath = toHeapMap(path);
+    std::vector<LocationQuery> heapQueries = makeTemporaryMapQueries(heapCities, heapPath, size);
+    std::vector<LocationQuery> inlineQueries = makeTemporaryMapQueries(cities, path, size);
+    for (size_t q = 0; q < heapQueries.size(); q++)
+      allMatch &= heapQueries[q].run() == inlineQueries[q].run();
+  }
+  return allMatch;
+}
+
+// on random maps, on maps with many equal values and with a mask rejecting a third of the
+// tiles, the threshold search is a kernel and is checked with every instruction set
+bool checkTopPoints()
+{
+  bool allMatch = true;
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    const InfluenceMap random = makeRandomMap(size, engine);
+    InfluenceMap ties{ size, size };
+    for (int i = 0; i < ties.getSize(); i++)
+      ties.setValueAtIndex(i, static_cast<float>(engine() % 4));
+    std::vector<bool> empty(size * size);
+    for (size_t i = 0; i < empty.size(); i++)
+      empty[i] = engine() % 3 != 0;
+    auto isEmpty = [&empty](tileindex_t tile) { return empty[tile] == true; };
+    auto anyTile = [](tileindex_t) { return true; };
+
+    for (int n : { 1, 4, 16, 100 }) {
+      const std::vector<tileindex_t> expected[] = { sortHighestPoints(random, n, anyTile), sortHighestPoints(ties, n, anyTile), sortHighestPoints(random, n, isEmpty) };
+      for (InstructionSet instructionSet : getSupportedInstructionSets()) {
+        influence_kernels::setInstructionSet(instructionSet);
+        allMatch &= expected[0] == random.getNHighestPoints(n);
+        allMatch &= expected[1] == ties.getNHighestPoints(n);
+        allMatch &= expected[2] == random.getNHighestPoints(n, isEmpty);
+      }
+    }
+  }
+  influence_kernels::setInstructionSet(influence_kernels::getBestInstructionSet());
+  return allMatch;
+}
+
+bool checkStamping()
+{
+  bool allMatch = true;
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    const InfluenceMap input = makeRandomMap(size, engine);
+    for (const Stamping &stamping : makeStampings(size, 3.f)) {
+      std::vector<float> expected(input.getRow(0), input.getRow(0) + size * size);
+      InfluenceMap result = input;
+      stamping.checked(expected);
+      stamping.boxed(result);
+      allMatch &= std::equal(expected.begin(), expected.end(), result.getRow(0));
+    }
+  }
+  return allMatch;
+}
+
+// squad detection on 'unitCount' random walks, each path blurred again and compared with every
+// other path against the similarity matrix. Summed in lanes and raised with multiplications the
+// similarities are equal up to rounding, and equal with every instruction set.
+bool checkSimilarity(int unitCount)
+{
+  constexpr int propagationRadius = 2;
+  bool allMatch = true;
+  float maxError = 0;
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    const std::vector<InfluenceMap> paths = makeSquadPaths(size, unitCount, propagationRadius, engine);
+    InfluenceDiffusion diffusion;
+    for (float tolerance : { 3.f, 4.f, 2.5f }) {
+      std::vector<float> expected;
+      for (const InfluenceMap &path : paths) {
+        InfluenceMap compared;
+        diffusion.propagate(path, propagationRadius, compared);
+        for (const InfluenceMap &other : paths)
+          expected.push_back(similarityWithPowf(compared, other, tolerance));
+      }
+
+      std::vector<float> reference;
+      for (InstructionSet instructionSet : getSupportedInstructionSets()) {
+        influence_kernels::setInstructionSet(instructionSet);
+        SimilarityMatrix matrix;
+        matrix.reset(paths, propagationRadius, tolerance);
+        std::vector<float> result;
+        for (size_t i = 0; i < paths.size(); i++)
+          for (size_t j = 0; j < paths.size(); j++)
+            result.push_back(matrix.get(i, j));
+        if (instructionSet == InstructionSet::SCALAR)
+          reference = result;
+        allMatch &= result == reference;
+        for (size_t i = 0; i < expected.size(); i++)
+          maxError = std::max(maxError, std::abs(expected[i] - result[i]));
+      }
+    }
+  }
+  influence_kernels::setInstructionSet(influence_kernels::getBestInstructionSet());
+  std::printf("%-14s max error %g\n", "similarity", maxError);
+  return allMatch && maxError < 1e-3f;
+}
+
+// the coverage checks of squad detection: a propagated path against the tiles near an enemy
+// city cluster, the positive tiles are found with a kernel and checked with every instruction set
+bool checkCoverage()
+{
+  using namespace influence_templates;
+  bool allMatch = true;
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    InfluenceDiffusion diffusion;
+    EnemyTrajectory trajectory;
+    std::vector<tileindex_t> walk = makeRandomWalk(size, 60, engine);
+    for (size_t turn = 0; turn < walk.size(); turn++)
+      trajectory.add(turn, walk[turn]);
+    const InfluenceMap path = trajectory.getPath(size, size, 50);
+    InfluenceMap propagatedPath;
+    diffusion.propagate(path, 2, propagatedPath);
+    InfluenceMap ccMap{ size, size };
+    ccMap.addTemplateAtIndex(static_cast<tileindex_t>(engine() % (size * size)), ENEMY_CITY_CLUSTER_PROXIMITY);
+
+    const TileSet pathTiles = path.getPositiveTiles(), propagatedTiles = propagatedPath.getPositiveTiles();
+    const TileSet clusterTiles = ccMap.getPositiveTiles();
+    for (InstructionSet instructionSet : getSupportedInstructionSets()) {
+      influence_kernels::setInstructionSet(instructionSet);
+      allMatch &= path.getPositiveTiles() == pathTiles && propagatedPath.getPositiveTiles() == propagatedTiles;
+    }
+    influence_kernels::setInstructionSet(influence_kernels::getBestInstructionSet());
+
+    for (int tilesNeeded : { 1, 3, 1000 }) {
+      allMatch &= coversTilesWithScan(propagatedPath, ccMap, tilesNeeded) == propagatedTiles.coversTiles(clusterTiles, tilesNeeded);
+      allMatch &= coversTilesWithScan(propagatedPath, ccMap, tilesNeeded) == propagatedPath.coversTiles(ccMap, tilesNeeded);
+    }
+    for (size_t random = 0; random < pathTiles.size(); random++)
+      allMatch &= getValuedPointWithScan(path, random) == pathTiles.getNth(random);
+  }
+  return allMatch;
+}
+
+// the heading of a unit along a random walk, kept up to date with its trajectory, against the
+// angle to every tile computed from its positions
+bool checkHeading(int turns, int window)
+{
+  constexpr float MAX_ANGLE = 3.14159265359f / 4;
+  const float minCosine = std::cos(MAX_ANGLE);
+  bool allMatch = true;
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    std::vector<tileindex_t> walk = makeRandomWalk(size, turns, engine);
+    EnemyTrajectory trajectory;
+    for (int turn = 0; turn < turns; turn++) {
+      trajectory.add(turn, walk[turn]);
+      trajectory.updateHeading(size, window);
+      if (turn % 16 != 0) continue;
+      const EnemyHeading &heading = trajectory.getHeading();
+      tileindex_t from = trajectory.getSample(std::min<size_t>(window, trajectory.getSampleCount() - 1)).tile;
+      double x = walk[turn] % size, y = walk[turn] / size;
+      double dx = x - from % size, dy = y - from / size;
+      for (int tile = 0; tile < size * size; tile++) {
+        double px = tile % size - x, py = tile / size - y;
+        double lengths = std::sqrt(dx * dx + dy * dy) * std::sqrt(px * px + py * py);
+        bool expected = lengths > 0 && std::acos(std::clamp((dx * px + dy * py) / lengths, -1., 1.)) <= MAX_ANGLE;
+        // decisions on the boundary depend on rounding
+        bool onBoundary = lengths > 0 && std::abs((dx * px + dy * py) / lengths - minCosine) < 1e-5;
+        allMatch &= onBoundary || heading.approaches(tile % size, tile / size, minCosine) == expected;
+      }
+    }
+  }
+  return allMatch;
+}
+
+// every diamond and a few rectangles around every tile, on integer maps like the neighbour
+// counts of pathing, where sums are exact, and on random values. The tables are rebuilt after
+// every change of the map.
+bool checkRegionSums()
+{
+  bool allMatch = true;
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    InfluenceMap integers{ size, size };
+    for (int i = 0; i < integers.getSize(); i++)
+      integers.setValueAtIndex(i, static_cast<float>(engine() % 4 == 0 ? engine() % 21 : 0));
+    InfluenceMap random = makeRandomMap(size, engine);
+
+    for (int change = 0; change < 2; change++) {
+      for (int radius : { 0, 1, 4, 2 * size }) {
+        for (int tile = 0; tile < size * size; tile++) {
+          int x = tile % size, y = tile / size;
+          allMatch &= integers.sumDiamond(x, y, radius) == static_cast<float>(sumDiamondWithLoop(integers, x, y, radius));
+          allMatch &= integers.sumRect(x - radius, y - 1, x + 1, y + radius) == static_cast<float>(sumRectWithLoop(integers, x - radius, y - 1, x + 1, y + radius));
+          allMatch &= std::abs(random.sumDiamond(x, y, radius) - sumDiamondWithLoop(random, x, y, radius)) < 1e-3;
+        }
+      }
+      integers.addValueAtIndex(static_cast<tileindex_t>(engine() % (size * size)), 3.f);
+      random.flip();
+    }
+  }
+  return allMatch;
+}
+
+// the stamps of computeInfluence on a given share of the tiles, one by one and splatted. Integer
+// weights like the resource amounts give the values of the stamps exactly, random weights are
+// checked with a tolerance.
+bool checkSplat()
+{
+  using namespace influence_templates;
+  bool allMatch = true;
+  for (int size : MAP_SIZES) {
+    std::mt19937 engine{ static_cast<unsigned>(size) };
+    for (int percent : { 5, 20, 40, 100 }) {
+      std::vector<std::pair<tileindex_t, float>> stamps, randomStamps;
+      makeSplatStamps(size, percent, engine, stamps, randomStamps);
+
+      auto stampOneByOne = [&](const auto &influenceTemplate, const auto &weights) {
+        InfluenceMap map{ size, size };
+        for (auto [tile, weight] : weights)
+          map.addTemplateAtIndex(tile, influenceTemplate, weight);
+        return map;
+      };
+      auto splat = [&](const auto &influenceTemplate, const auto &weights) {
+        InfluenceMap map{ size, size };
+        TemplateSplat splat{ size, size };
+        for (auto [tile, weight] : weights)
+          splat.add(tile, weight);
+        splat.addTo(map, influenceTemplate);
+        return map;
+      };
+
+      allMatch &= sameValues(stampOneByOne(RESOURCE_PROXIMITY, stamps), splat(RESOURCE_PROXIMITY, stamps));
+      allMatch &= sameValues(stampOneByOne(AGENT_PROXIMITY, stamps), splat(AGENT_PROXIMITY, stamps));
+      const InfluenceMap expected = stampOneByOne(RESOURCE_PROXIMITY, randomStamps), result = splat(RESOURCE_PROXIMITY, randomStamps);
+      for (int i = 0; i < size * size; i++)
+        allMatch &= std::abs(expected.getValue(i) - result.getValue(i)) < 1e-3f;
+    }
+  }
+  return allMatch;
+}
+
+}
+
+int main()
+{
+  const std::pair<const char *, bool (*)()> checks[] = {
+    { "operations", checkOperations },
+    { "diffusion",  [] { return checkDiffusion(2, 8); } },
+    { "trajectory", [] { return checkTrajectory(360, 50); } },
+    { "storage",    checkStorage },
+    { "top n",      checkTopPoints },
+    { "stamp",      checkStamping },
+    { "similarity", [] { return checkSimilarity(12); } },
+    { "coverage",   checkCoverage },
+    { "heading",    [] { return checkHeading(360, 5); } },
+    { "region sums",checkRegionSums },
+    { "splat",      checkSplat },
+  };
+
+  bool allMatch = true;
+  for (auto [name, check] : checks) {
+    bool match = check();
+    allMatch &= match;
+    std::printf("%-14s %s\n", name, match ? "ok" : "MISMATCH");
+  }
+  std::printf("\n%s\n", allMatch ? "all results match the reference implementations" : "some results differ from the reference implementations");
+  return allMatch ? 0 : 1;
+}
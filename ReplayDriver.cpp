@@ -0,0 +1,427 @@
+// Offline benchmark, replays recorded agent inputs through kit::Agent without the lux-ai engine.
+//
+//   ReplayDriver <transcript|recording> [-n loops] [-o orders.txt] [-t first turn]
+//
+// The transcript is what the agent reads on stdin during a match (player id, map size, then
+// every turn up to D_DONE), a recording is the binary file written by "main --record" (see
+// TurnRecording.h). The whole match is replayed 'loops' times with a fresh agent and
+// latencies are reported per phase and per turn. Phases are the agent's own BENCHMARK_* logs
+// when BENCHMARKING is defined, plus ExtractGameState/GetTurnOrders/TurnTotal measured here.
+// Recordings can be replayed from any turn with -t, the agent then starts from an empty
+// state at that turn (its turn counter, used for the night budget and the late game
+// objectives, starts at that turn too). Replaying a recording from its first turn also
+// checks that the orders are the recorded ones. The first replay also checks every turn's
+// GameStateDiff against a full comparison of the extracted state with the previous one.
+
+#include "lux/agent.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "AIParams.h"
+#include "Benchmarking.h"
+#include "GameRules.h"
+#include "TurnRecording.h"
+#include "lux/annotate.hpp"
+
+namespace
+{
+
+// latency samples in ms, kept in the order phases first appear
+struct PhaseSamples
+{
+  std::string name;
+  std::vector<double> samples;
+};
+
+class LatencyReport
+{
+public:
+  void add(std::string_view phase, double ms)
+  {
+    auto it = std::ranges::find(m_phases, phase, &PhaseSamples::name);
+    if (it == m_phases.end())
+      it = m_phases.insert(m_phases.end(), PhaseSamples{ std::string(phase), {} });
+    it->samples.push_back(ms);
+  }
+
+  // reads the "<duration>ms for <name>[ x<count>]" lines written by the BENCHMARK_* macros
+  void addBenchmarkLogs(const std::string &logs)
+  {
+    std::istringstream lines{ logs };
+    std::string line;
+    while (std::getline(lines, line)) {
+      size_t unit = line.find("ms for ");
+      if (unit == std::string::npos) continue;
+      std::string name = line.substr(unit + 7);
+      name = name.substr(0, name.find(' '));
+      add(name, std::stod(line.substr(0, unit)));
+    }
+  }
+
+  void print(std::ostream &out)
+  {
+    char row[160];
+    std::snprintf(row, sizeof(row), "%-32s %8s %10s %10s %10s %10s\n", "phase (ms)", "samples", "min", "median", "p99", "max");
+    out << row;
+    for (PhaseSamples &phase : m_phases) {
+      std::vector<double> &s = phase.samples;
+      std::ranges::sort(s);
+      std::snprintf(row, sizeof(row), "%-32s %8zu %10.4f %10.4f %10.4f %10.4f\n",
+        phase.name.c_str(), s.size(), s.front(), percentile(s, .5), percentile(s, .99), s.back());
+      out << row;
+    }
+  }
+
+  // s must be sorted, nearest-rank percentile
+  static double percentile(const std::vector<double> &s, double p)
+  {
+    size_t rank = static_cast<size_t>(p * static_cast<double>(s.size()) + .5);
+    return s[std::clamp<size_t>(rank, 1, s.size()) - 1];
+  }
+
+private:
+  std::vector<PhaseSamples> m_phases;
+};
+
+// memory of the enemy trajectories at the end of the game, compared with the two dense maps
+// per enemy they replace
+void printTrajectoryReport(std::ostream &out, const GameState &state)
+{
+  size_t count = state.ennemyTrajectories.size();
+  char row[160];
+  std::snprintf(row, sizeof(row), "enemy trajectories: %zu units, %.1f KB (%.1f KB as dense paths)\n",
+    count, count * sizeof(EnemyTrajectory) / 1e3, count * 2 * sizeof(InfluenceMap) / 1e3);
+  out << row;
+}
+
+// Checks the GameStateDiff built by ExtractGameState against the changes found by comparing
+// the whole extracted state with the one of the previous turn, field by field. The first turn
+// is compared with an empty state, as the agent does.
+class DiffChecker
+{
+public:
+  // to be called after every ExtractGameState, before GetTurnOrders changes the state
+  void check(const GameState &state, const GameStateDiff &diff)
+  {
+    const Map &map = state.map;
+    if (m_tiles.size() != map.getMapSize()) {
+      m_tiles.assign(map.getMapSize(), Tile{});
+      m_depleted.assign(map.getMapSize(), false);
+      m_lostCities.assign(map.getMapSize(), false);
+    }
+
+    std::vector<UnitSnapshot> units;
+    for (unithandle_t unit : state.units) {
+      const UnitStore &store = *state.unitStore;
+      units.push_back({ store.getId(unit), map.getTileIndex(store.getX(unit), store.getY(unit)), store.getTeam(unit), store.getType(unit) });
+    }
+    std::ranges::sort(units, {}, &UnitSnapshot::id);
+
+    GameStateDiffIds expected;
+    auto previous = m_units.begin();
+    for (const UnitSnapshot &unit : units) {
+      for (; previous != m_units.end() && previous->id < unit.id; previous++)
+        expected.addDead(*previous);
+      if (previous == m_units.end() || previous->id != unit.id) {
+        expected.newBots.push_back(unit.id);
+        if (unit.type == UnitType::CITY)
+          expected.newCityTiles[unit.team].push_back(unit.tile);
+        continue;
+      }
+      if (previous->tile != unit.tile)
+        expected.movedBots.push_back({ unit.id, previous->tile, unit.tile });
+      previous++;
+    }
+    for (; previous != m_units.end(); previous++)
+      expected.addDead(*previous);
+
+    for (tileindex_t tile = 0; tile < map.getMapSize(); tile++) {
+      const Tile &before = m_tiles[tile], &after = map.tileAt(tile);
+      int amountBefore = before.getType() == TileType::RESOURCE ? before.getResourceAmount() : 0;
+      if (after.getType() == TileType::RESOURCE && after.getResourceAmount() != amountBefore)
+        expected.updatedResources.push_back(tile);
+      if (before.getType() == TileType::RESOURCE && after.getType() != TileType::RESOURCE)
+        expected.depletedResources.push_back(tile);
+      if (after.getRoadAmount() != before.getRoadAmount())
+        expected.updatedRoads.push_back(tile);
+    }
+
+    for (player_t team = 0; team < Player::COUNT; team++) {
+      auto crossed = [&](size_t threshold) { return m_researchPoints[team] < threshold && state.playerResearchPoints[team] >= threshold; };
+      if (crossed(game_rules::MIN_RESEARCH_COAL))
+        expected.unlockedResources[team].push_back(kit::ResourceType::coal);
+      if (crossed(game_rules::MIN_RESEARCH_URANIUM))
+        expected.unlockedResources[team].push_back(kit::ResourceType::uranium);
+      m_researchPoints[team] = state.playerResearchPoints[team];
+    }
+
+    GameStateDiffIds actual{ diff };
+    for (size_t field = 0; field < GameStateDiffIds::FIELD_COUNT; field++) {
+      if (!expected.sameField(actual, field))
+        m_mismatchingTurns[field]++;
+    }
+
+    // edge cases, counted to know that the recordings went through them
+    for (tileindex_t tile : expected.updatedResources) {
+      m_resentResources += m_depleted[tile];
+      m_depleted[tile] = false;
+    }
+    for (tileindex_t tile : expected.depletedResources)
+      m_depleted[tile] = true;
+    for (player_t team = 0; team < Player::COUNT; team++) {
+      for (tileindex_t tile : expected.newCityTiles[team]) {
+        m_rebuiltCities += m_lostCities[tile];
+        m_lostCities[tile] = false;
+      }
+      for (tileindex_t tile : expected.lostCityTiles[team])
+        m_lostCities[tile] = true;
+    }
+
+    std::copy_n(&map.tileAt(0), map.getMapSize(), m_tiles.begin());
+    m_units.swap(units);
+    m_turns++;
+  }
+
+  size_t getMismatchingTurns() const { return std::accumulate(m_mismatchingTurns.begin(), m_mismatchingTurns.end(), size_t{}); }
+
+  void print(std::ostream &out) const
+  {
+    out << "game state diffs: " << m_turns << " turns checked, " << m_resentResources << " resources re-sent after depletion, "
+      << m_rebuiltCities << " city tiles rebuilt\n";
+    for (size_t field = 0; field < GameStateDiffIds::FIELD_COUNT; field++) {
+      if (m_mismatchingTurns[field] > 0)
+        out << "  " << m_mismatchingTurns[field] << " turns with a wrong " << GameStateDiffIds::FIELD_NAMES[field] << "\n";
+    }
+  }
+
+private:
+  struct UnitSnapshot
+  {
+    unitid_t id;
+    tileindex_t tile;
+    player_t team;
+    UnitType type;
+  };
+
+  // GameStateDiff with units by id, fields are compared as sets
+  struct GameStateDiffIds
+  {
+    static constexpr size_t FIELD_COUNT = 9;
+    static constexpr std::array<const char *, FIELD_COUNT> FIELD_NAMES{
+      "deadBots", "newBots", "movedBots", "updatedRoads", "updatedResources", "depletedResources",
+      "newCityTiles", "lostCityTiles", "unlockedResources",
+    };
+
+    std::vector<unitid_t> deadBots, newBots;
+    std::vector<std::tuple<unitid_t, tileindex_t, tileindex_t>> movedBots;
+    std::vector<tileindex_t> updatedRoads, updatedResources, depletedResources;
+    std::array<std::vector<tileindex_t>, Player::COUNT> newCityTiles, lostCityTiles;
+    std::array<std::vector<kit::ResourceType>, Player::COUNT> unlockedResources;
+
+    GameStateDiffIds() = default;
+    explicit GameStateDiffIds(const GameStateDiff &diff)
+      : updatedRoads(diff.updatedRoads), updatedResources(diff.updatedResources), depletedResources(diff.depletedResources),
+      newCityTiles(diff.newCityTiles), lostCityTiles(diff.lostCityTiles), unlockedResources(diff.unlockedResources)
+    {
+      for (Bot *bot : diff.deadBots) deadBots.push_back(bot->getId());
+      for (Bot *bot : diff.newBots) newBots.push_back(bot->getId());
+      for (const GameStateDiff::UnitMove &move : diff.movedBots) movedBots.push_back({ move.bot->getId(), move.from, move.to });
+    }
+
+    void addDead(const UnitSnapshot &unit)
+    {
+      deadBots.push_back(unit.id);
+      if (unit.type == UnitType::CITY)
+        lostCityTiles[unit.team].push_back(unit.tile);
+    }
+
+    bool sameField(GameStateDiffIds &other, size_t field)
+    {
+      auto same = [](auto &a, auto &b) { std::ranges::sort(a); std::ranges::sort(b); return a == b; };
+      auto samePerTeam = [&](auto &a, auto &b) { return same(a[Player::ALLY], b[Player::ALLY]) && same(a[Player::ENEMY], b[Player::ENEMY]); };
+      switch (field) {
+      case 0: return same(deadBots, other.deadBots);
+      case 1: return same(newBots, other.newBots);
+      case 2: return same(movedBots, other.movedBots);
+      case 3: return same(updatedRoads, other.updatedRoads);
+      case 4: return same(updatedResources, other.updatedResources);
+      case 5: return same(depletedResources, other.depletedResources);
+      case 6: return samePerTeam(newCityTiles, other.newCityTiles);
+      case 7: return samePerTeam(lostCityTiles, other.lostCityTiles);
+      default: return samePerTeam(unlockedResources, other.unlockedResources);
+      }
+    }
+  };
+
+  std::vector<Tile> m_tiles;
+  std::vector<UnitSnapshot> m_units; // by id
+  size_t m_researchPoints[Player::COUNT]{};
+  std::array<size_t, GameStateDiffIds::FIELD_COUNT> m_mismatchingTurns{};
+  size_t m_turns = 0;
+  std::vector<bool> m_depleted, m_lostCities;
+  size_t m_resentResources = 0, m_rebuiltCities = 0;
+};
+
+size_t countTurns(std::string_view transcript)
+{
+  size_t turns = 0;
+  for (size_t at = transcript.find(kit::INPUT_CONSTANTS::DONE); at != std::string_view::npos; at = transcript.find(kit::INPUT_CONSTANTS::DONE, at + 1))
+    turns++;
+  return turns;
+}
+
+double elapsedMs(std::chrono::high_resolution_clock::time_point since)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - since).count() / 1e6;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+  std::string transcriptPath;
+  std::string ordersPath;
+  size_t loops = 1;
+  size_t firstTurn = 1;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-n" && i + 1 < argc)
+      loops = std::max(1, std::stoi(argv[++i]));
+    else if (arg == "-o" && i + 1 < argc)
+      ordersPath = argv[++i];
+    else if (arg == "-t" && i + 1 < argc)
+      firstTurn = std::max(1, std::stoi(argv[++i]));
+    else
+      transcriptPath = arg;
+  }
+  if (transcriptPath.empty()) {
+    std::cerr << "usage: " << argv[0] << " <transcript|recording> [-n loops] [-o orders.txt] [-t first turn]" << std::endl;
+    return 1;
+  }
+
+  std::string transcript;
+  TurnRecording recording;
+  if (recording.open(transcriptPath)) {
+    transcript = recording.toTranscript(firstTurn);
+  } else {
+    std::ifstream file{ transcriptPath, std::ios::binary };
+    if (!file) {
+      std::cerr << "Could not open " << transcriptPath << std::endl;
+      return 1;
+    }
+    if (firstTurn != 1) {
+      std::cerr << "-t is only supported for recordings" << std::endl;
+      return 1;
+    }
+    transcript.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  size_t turnCount = countTurns(transcript);
+  bool checkOrders = recording.getTurnCount() > 0 && firstTurn == 1;
+  size_t mismatchingTurns = 0;
+
+  params::trainingMode = false;
+  std::ofstream ordersFile;
+  if (!ordersPath.empty())
+    ordersFile.open(ordersPath);
+
+  LatencyReport report;
+  std::vector<std::vector<double>> turnTotals(turnCount);
+  std::ostringstream trajectoryReport;
+  DiffChecker diffChecker;
+
+  try {
+    for (size_t loop = 0; loop < loops; loop++) {
+      kit::InputReader input{ transcript };
+      kit::Agent agent{ input };
+      agent.Initialize(firstTurn);
+
+      for (size_t turn = 1; turn <= turnCount; turn++) {
+#ifdef BENCHMARKING
+        benchmark::logs.str("");
+#endif
+        MULTIBENCHMARK_BEGIN(Astar);
+        MULTIBENCHMARK_BEGIN(AgentBT);
+        MULTIBENCHMARK_BEGIN(getBestCityBuildingLocation);
+        MULTIBENCHMARK_BEGIN(getBestCityFeedingLocation);
+        MULTIBENCHMARK_BEGIN(propagateAllTimes);
+        MULTIBENCHMARK_BEGIN(unitScans);
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        agent.ExtractGameState();
+        double extractMs = elapsedMs(t0);
+        if (loop == 0)
+          diffChecker.check(agent.getGameState(), agent.getGameStateDiff());
+
+        // same as main.cpp, orders are only asked up to the last turn of a full game
+        size_t gameTurn = turn + firstTurn - 1;
+        auto t1 = std::chrono::high_resolution_clock::now();
+        std::vector<std::string> orders;
+        lux::Annotate::s_logs.swap(orders);
+        if (gameTurn < game_rules::GAME_LENGTH) agent.GetTurnOrders(orders);
+        double ordersMs = elapsedMs(t1);
+        double totalMs = extractMs + ordersMs;
+
+        MULTIBENCHMARK_END(AgentBT);
+        MULTIBENCHMARK_END(Astar);
+        MULTIBENCHMARK_END(getBestCityBuildingLocation);
+        MULTIBENCHMARK_END(getBestCityFeedingLocation);
+        MULTIBENCHMARK_END(propagateAllTimes);
+        MULTIBENCHMARK_END(unitScans);
+
+        report.add("ExtractGameState", extractMs);
+        report.add("GetTurnOrders", ordersMs);
+        report.add("TurnTotal", totalMs);
+#ifdef BENCHMARKING
+        report.addBenchmarkLogs(benchmark::logs.str());
+#endif
+        turnTotals[turn - 1].push_back(totalMs);
+
+        if (loop == 0) {
+          std::string ordersLine;
+          for (size_t i = 0; i < orders.size(); i++)
+            ordersLine += (i == 0 ? "" : ",") + orders[i];
+          if (ordersFile)
+            ordersFile << ordersLine << "\nD_FINISH\n";
+          if (checkOrders && ordersLine != recording.getTurnOrders(turn))
+            mismatchingTurns++;
+        }
+      }
+      if (loop == 0)
+        printTrajectoryReport(trajectoryReport, agent.getGameState());
+    }
+  } catch (const std::runtime_error &e) {
+    std::cerr << "Fatal error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::cout << turnCount << " turns x" << loops << " from " << transcriptPath << "\n";
+  if (checkOrders)
+    std::cout << mismatchingTurns << " turns with orders different from the recording\n";
+  diffChecker.print(std::cout);
+  std::cout << trajectoryReport.str() << "\n";
+  report.print(std::cout);
+
+  // slowest turns by median over the loops
+  std::vector<std::pair<double, size_t>> turnMedians;
+  for (size_t turn = 0; turn < turnCount; turn++) {
+    std::ranges::sort(turnTotals[turn]);
+    turnMedians.emplace_back(LatencyReport::percentile(turnTotals[turn], .5), turn + firstTurn);
+  }
+  std::ranges::sort(turnMedians, std::greater{});
+  std::cout << "\nslowest turns (median ms):";
+  for (size_t i = 0; i < std::min<size_t>(10, turnMedians.size()); i++)
+    std::cout << " " << turnMedians[i].second << ":" << turnMedians[i].first;
+  std::cout << std::endl;
+
+  // unlike orders, which change with the parameters, the diffs must always be right
+  return diffChecker.getMismatchingTurns() == 0 ? 0 : 1;
+}
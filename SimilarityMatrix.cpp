@@ -0,0 +1,45 @@
+#include "SimilarityMatrix.h"
+
+#include <algorithm>
+
+void SimilarityMatrix::reset(std::span<const InfluenceMap> paths, int propagationRadius, float similarityTolerance)
+{
+  m_count = paths.size();
+  m_tolerance = similarityTolerance;
+  m_similarities.resize(m_count * m_count);
+  m_computedRows.assign(m_count, false);
+  if (paths.empty()) return;
+
+  size_t size = static_cast<size_t>(paths[0].getSize());
+  m_stride = (size + influence_kernels::VECTOR_WIDTH - 1) / influence_kernels::VECTOR_WIDTH * influence_kernels::VECTOR_WIDTH;
+  m_paths.assign(m_count * m_stride, 0.f);
+  m_comparedPaths.assign(m_count * m_stride, 0.f);
+
+  m_sources.clear();
+  for (const InfluenceMap &path : paths)
+    m_sources.push_back(&path);
+  m_blurred.resize(m_count);
+  m_diffusion.propagate(m_sources, propagationRadius, m_blurred);
+
+  for (size_t i = 0; i < m_count; i++) {
+    storePath(m_paths, i, paths[i]);
+    storePath(m_comparedPaths, i, m_blurred[i]);
+  }
+}
+
+void SimilarityMatrix::computeRow(size_t row)
+{
+  // the padding is zero in both buffers and skipped by the kernel
+  const float *compared = getPath(m_comparedPaths, row);
+  float *similarities = m_similarities.data() + row * m_count;
+  for (size_t column = 0; column < m_count; column++) {
+    auto [similarity, count] = influence_kernels::similarity(compared, getPath(m_paths, column), m_stride, m_tolerance);
+    similarities[column] = similarity * 100.f / count;
+  }
+  m_computedRows[row] = true;
+}
+
+void SimilarityMatrix::storePath(Buffer &buffer, size_t path, const InfluenceMap &map)
+{
+  std::copy_n(map.getRow(0), map.getSize(), buffer.data() + path * m_stride);
+}
@@ -0,0 +1,53 @@
+#ifndef SIMILARITY_MATRIX_H
+#define SIMILARITY_MATRIX_H
+
+#include <span>
+#include <vector>
+
+#include "AlignedAllocator.h"
+#include "InfluenceDiffusion.h"
+#include "InfluenceKernels.h"
+#include "InfluenceMap.h"
+
+// Pairwise similarities of the enemy paths, squad detection looks them up instead of comparing
+// maps. get(i, j) is the similarity of path i blurred once more with path j, like
+// InfluenceMap::getSimilarity. Path i is blurred one more time than path j so the matrix is not
+// symmetric.
+// The paths and their blurred versions are stacked in two contiguous buffers, rows are padded
+// with zeros to a multiple of the vector width. The second blur is a single batched diffusion.
+// Squad detection usually groups every unit within the first rows, a row is only computed on
+// its first use and kept until the next reset. Buffers are kept between resets.
+class SimilarityMatrix
+{
+public:
+  // 'paths' must all have the same size
+  void reset(std::span<const InfluenceMap> paths, int propagationRadius, float similarityTolerance);
+
+  size_t size() const { return m_count; }
+  float get(size_t row, size_t column)
+  {
+    if (!m_computedRows[row])
+      computeRow(row);
+    return m_similarities[row * m_count + column];
+  }
+
+private:
+  using Buffer = std::vector<float, AlignedAllocator<float, influence_kernels::ALIGNMENT>>;
+
+  void computeRow(size_t row);
+  const float *getPath(const Buffer &buffer, size_t path) const { return buffer.data() + path * m_stride; }
+  void storePath(Buffer &buffer, size_t path, const InfluenceMap &map);
+
+  InfluenceDiffusion m_diffusion;
+  std::vector<const InfluenceMap *> m_sources;
+  std::vector<InfluenceMap> m_blurred;
+  Buffer m_paths;
+  Buffer m_comparedPaths;
+  std::vector<float> m_similarities; // m_count rows of m_count values
+  std::vector<char> m_computedRows;
+  size_t m_count = 0;
+  size_t m_stride = 0;
+  float m_tolerance = 1.f;
+};
+
+#endif
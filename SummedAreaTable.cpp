@@ -0,0 +1,48 @@
+#include "SummedAreaTable.h"
+
+#include <algorithm>
+
+void SummedAreaTable::build(const float *values, int width, int height)
+{
+  m_width = width;
+  m_height = height;
+  const int stride = width + 1;
+  m_rect.assign(static_cast<size_t>(stride) * (height + 1), 0.);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++)
+      m_rect[(y + 1) * stride + x + 1] = values[y * width + x] + m_rect[y * stride + x + 1] + m_rect[(y + 1) * stride + x] - m_rect[y * stride + x];
+  }
+
+  // tile (x, y) is at u = x + y, v = x - y + height - 1
+  m_rotatedSize = width + height - 1;
+  const int rotatedStride = m_rotatedSize + 1;
+  m_rotated.assign(static_cast<size_t>(rotatedStride) * rotatedStride, 0.);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++)
+      m_rotated[(x + y + 1) * rotatedStride + x - y + height] = values[y * width + x];
+  }
+  for (int u = 0; u < m_rotatedSize; u++) {
+    for (int v = 0; v < m_rotatedSize; v++)
+      m_rotated[(u + 1) * rotatedStride + v + 1] += m_rotated[u * rotatedStride + v + 1] + m_rotated[(u + 1) * rotatedStride + v] - m_rotated[u * rotatedStride + v];
+  }
+}
+
+float SummedAreaTable::sumRect(int x0, int y0, int x1, int y1) const
+{
+  x0 = std::max(x0, 0);
+  y0 = std::max(y0, 0);
+  x1 = std::min(x1, m_width - 1);
+  y1 = std::min(y1, m_height - 1);
+  if (x0 > x1 || y0 > y1) return 0;
+  return static_cast<float>(sumTable(m_rect, m_width + 1, x0, y0, x1, y1));
+}
+
+float SummedAreaTable::sumDiamond(int x, int y, int radius) const
+{
+  const int u = x + y, v = x - y + m_height - 1;
+  const int u0 = std::max(u - radius, 0), u1 = std::min(u + radius, m_rotatedSize - 1);
+  const int v0 = std::max(v - radius, 0), v1 = std::min(v + radius, m_rotatedSize - 1);
+  if (u0 > u1 || v0 > v1) return 0;
+  // rows of the table are u, columns are v
+  return static_cast<float>(sumTable(m_rotated, m_rotatedSize + 1, v0, u0, v1, u1));
+}
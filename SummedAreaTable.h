@@ -0,0 +1,71 @@
+#ifndef SUMMED_AREA_TABLE_H
+#define SUMMED_AREA_TABLE_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Prefix sums of a map that answer region sums in constant time, see BasicInfluenceMap::sumRect.
+// Rectangles use a table on the map grid. Manhattan diamonds are rectangles on the grid rotated
+// by 45 degrees (u = x + y, v = x - y), they use a second table on that grid where the cells
+// that are not tiles hold zeros. Sums are accumulated in doubles so that differences of large
+// prefixes stay exact for the integer valued maps they are used on.
+class SummedAreaTable
+{
+public:
+  void build(const float *values, int width, int height);
+
+  // inclusive bounds, clipped by the map borders
+  float sumRect(int x0, int y0, int x1, int y1) const;
+  // tiles up to 'radius' tiles away from (x, y) in manhattan distance, clipped by the map borders
+  float sumDiamond(int x, int y, int radius) const;
+
+private:
+  static double sumTable(const std::vector<double> &table, int stride, int x0, int y0, int x1, int y1)
+  {
+    return table[(y1 + 1) * stride + x1 + 1] - table[y0 * stride + x1 + 1] - table[(y1 + 1) * stride + x0] + table[y0 * stride + x0];
+  }
+
+  int m_width = 0, m_height = 0;
+  int m_rotatedSize = 0;
+  std::vector<double> m_rect;    // (width + 1) * (height + 1), the first row and column are zeros
+  std::vector<double> m_rotated; // same on the rotated grid of rotatedSize^2 cells
+};
+
+// Tables owned by a map, built by the first region sum after the map changed. The map calls
+// invalidate() when its values change. Copies of a map do not share its tables, a copy builds
+// its own on its first region sum.
+class SummedAreaCache
+{
+public:
+  SummedAreaCache() = default;
+  SummedAreaCache(const SummedAreaCache &) {}
+  SummedAreaCache &operator=(const SummedAreaCache &) { invalidate(); return *this; }
+  SummedAreaCache(SummedAreaCache &&other) noexcept
+    : m_table(std::move(other.m_table)), m_valid(std::exchange(other.m_valid, false)) {}
+  SummedAreaCache &operator=(SummedAreaCache &&other) noexcept
+  {
+    m_table = std::move(other.m_table);
+    m_valid = std::exchange(other.m_valid, false);
+    return *this;
+  }
+
+  void invalidate() { m_valid = false; }
+
+  const SummedAreaTable &get(const float *values, int width, int height)
+  {
+    if (!m_valid) {
+      if (!m_table)
+        m_table = std::make_unique<SummedAreaTable>();
+      m_table->build(values, width, height);
+      m_valid = true;
+    }
+    return *m_table;
+  }
+
+private:
+  std::unique_ptr<SummedAreaTable> m_table;
+  bool m_valid = false;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "TemplateSplat.h"
+
+#include <algorithm>
+
+void TemplateSplat::convolve(int range, float center, float slope)
+{
+  const int width = m_width;
+  std::fill_n(m_sums.begin(), width, 0.);
+  std::fill_n(m_momentsY.begin(), width, 0.);
+  std::fill_n(m_momentsX.begin(), width, 0.);
+
+  // along the rows: window sums and sums of |dx| * weight, accumulated down the columns.
+  // The row prefix sums are extended by 'range' on both sides so that the windows need no
+  // clipping, the weights outside of the map are zeros.
+  range = std::min(range, MAX_SIZE);
+  std::array<double, 3 * MAX_SIZE + 1> rowSumsBuffer, rowMomentsBuffer;
+  double *rowSums = rowSumsBuffer.data() + MAX_SIZE, *rowMoments = rowMomentsBuffer.data() + MAX_SIZE;
+  std::fill(rowSums - range, rowSums + 1, 0.);
+  std::fill(rowMoments - range, rowMoments + 1, 0.);
+  for (int y = 0; y < m_height; y++) {
+    const float *weights = m_weights.data() + y * width;
+    for (int x = 0; x < width; x++) {
+      rowSums[x + 1] = rowSums[x] + weights[x];
+      rowMoments[x + 1] = rowMoments[x] + static_cast<double>(x) * weights[x];
+    }
+    std::fill(rowSums + width + 1, rowSums + width + range + 1, rowSums[width]);
+    std::fill(rowMoments + width + 1, rowMoments + width + range + 1, rowMoments[width]);
+
+    const double *sumsAbove = m_sums.data() + y * width, *momentsYAbove = m_momentsY.data() + y * width, *momentsXAbove = m_momentsX.data() + y * width;
+    double *sums = m_sums.data() + (y + 1) * width, *momentsY = m_momentsY.data() + (y + 1) * width, *momentsX = m_momentsX.data() + (y + 1) * width;
+    for (int x = 0; x < width; x++) {
+      const double left = rowSums[x + 1] - rowSums[x - range], right = rowSums[x + range + 1] - rowSums[x + 1];
+      // (x - i) * weight on the left of x, (i - x) * weight on its right
+      const double moment = x * (left - right) - (rowMoments[x + 1] - rowMoments[x - range]) + (rowMoments[x + range + 1] - rowMoments[x + 1]);
+      sums[x] = sumsAbove[x] + left + right;
+      momentsY[x] = momentsYAbove[x] + y * (left + right);
+      momentsX[x] = momentsXAbove[x] + moment;
+    }
+  }
+
+  // along the columns, the same on the row window sums, for all the columns of a row at once
+  for (int y = 0; y < m_height; y++) {
+    const int lo = std::max(y - range, 0), hi = std::min(y + range, m_height - 1);
+    const double *sumsLo = m_sums.data() + lo * width, *sumsY = m_sums.data() + (y + 1) * width, *sumsHi = m_sums.data() + (hi + 1) * width;
+    const double *momentsLo = m_momentsY.data() + lo * width, *momentsY = m_momentsY.data() + (y + 1) * width, *momentsHi = m_momentsY.data() + (hi + 1) * width;
+    const double *momentsXLo = m_momentsX.data() + lo * width, *momentsXHi = m_momentsX.data() + (hi + 1) * width;
+    float *result = m_result.data() + y * width;
+    for (int x = 0; x < width; x++) {
+      const double sum = sumsHi[x] - sumsLo[x];
+      const double momentY = y * (sumsY[x] - sumsLo[x]) - (momentsY[x] - momentsLo[x])
+        + (momentsHi[x] - momentsY[x]) - y * (sumsHi[x] - sumsY[x]);
+      const double momentX = momentsXHi[x] - momentsXLo[x];
+      result[x] = static_cast<float>(center * sum - slope * (momentX + momentY));
+    }
+  }
+}
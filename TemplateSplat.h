@@ -0,0 +1,106 @@
+#ifndef TEMPLATE_SPLAT_H
+#define TEMPLATE_SPLAT_H
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#include "GameRules.h"
+#include "InfluenceKernels.h"
+#include "InfluenceMap.h"
+#include "Types.h"
+
+// Many stamps of the same template at once, like computeInfluence does on every resource tile.
+// The weights of the stamps are written ("splatted") in a grid which is then convolved with
+// the template, the cost is a few passes over the map whatever the number of stamps. With few
+// stamps adding them one by one is cheaper, see shouldConvolve.
+// Only for templates whose values fall linearly with the manhattan distance over the whole box,
+// center - slope * (|dx| + |dy|) like RESOURCE_PROXIMITY: the convolution splits into window
+// sums of the weights and of their first moments along each axis, all answered by prefix sums.
+// Sums are accumulated in doubles, for integer weights the result is exactly the one of the
+// stamps. Buffers are kept between turns, an instance should be reused.
+class TemplateSplat
+{
+public:
+  static constexpr int MAX_SIZE = game_rules::MAX_MAP_SIZE;
+
+  // true if the template can be splatted
+  template <unsigned W, unsigned H>
+  static constexpr bool isLinearFalloff(const InfluenceTemplate<W, H> &influenceTemplate)
+  {
+    if (W != H || W % 2 == 0 || W == 1) return false;
+    constexpr int range = W / 2;
+    const float center = influenceTemplate.getValue(range, range);
+    const float slope = center - influenceTemplate.getValue(range + 1, range);
+    for (int y = 0; y < static_cast<int>(H); y++) {
+      for (int x = 0; x < static_cast<int>(W); x++) {
+        if (influenceTemplate.getValue(x, y) != center - slope * (absolute(x - range) + absolute(y - range)))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  // true if 'stampCount' stamps of a W*H template on a width*height map are cheaper to splat
+  // than to add one by one
+  template <unsigned W, unsigned H>
+  static constexpr bool shouldConvolve(const InfluenceTemplate<W, H> &, size_t stampCount, int width, int height)
+  {
+    return stampCount * W * H >= static_cast<size_t>(CONVOLUTION_COST * width * height);
+  }
+
+  TemplateSplat() = default;
+  TemplateSplat(int width, int height) { setSize(width, height); }
+
+  // clears the weights
+  void setSize(int width, int height)
+  {
+    if (width > MAX_SIZE || height > MAX_SIZE)
+      throw std::runtime_error("Map too large for a template splat");
+    m_width = width;
+    m_height = height;
+    clear();
+  }
+  void clear() { std::fill_n(m_weights.begin(), m_width * m_height, 0.f); }
+
+  // same as a stamp with this weight at 'index'
+  void add(tileindex_t index, float weight) { m_weights[index] += weight; }
+
+  // adds the stamps to 'map', as addTemplateAtIndex(index, influenceTemplate, weight) would for
+  // every splatted weight. The map must have the size of the splat.
+  template <unsigned W, unsigned H>
+  void addTo(InfluenceMap &map, const InfluenceTemplate<W, H> &influenceTemplate)
+  {
+    if (!isLinearFalloff(influenceTemplate))
+      throw std::runtime_error("Template without a linear falloff");
+    const float center = influenceTemplate.getValue(W / 2, W / 2);
+    convolve(W / 2, center, center - influenceTemplate.getValue(W / 2 + 1, W / 2));
+    influence_kernels::addScaled(map.m_map.data(), m_result.data(), 1.f, static_cast<size_t>(m_width) * m_height);
+    map.m_sums.invalidate();
+  }
+
+private:
+  static constexpr size_t MAX_TILES = MAX_SIZE * MAX_SIZE;
+  // a row of zeros and a row per map row
+  static constexpr size_t PREFIX_SIZE = (MAX_SIZE + 1) * MAX_SIZE;
+
+  // cost of the convolution per tile of the map, in template values added by the stamps,
+  // measured by Microbench
+  static constexpr int CONVOLUTION_COST = 10;
+
+  // fills m_result with the convolution of the weights by center - slope * (|dx| + |dy|) over
+  // the box of 'range' tiles around each tile
+  void convolve(int range, float center, float slope);
+
+  int m_width = 0, m_height = 0;
+  std::array<float, MAX_TILES> m_weights;
+  std::array<float, MAX_TILES> m_result;
+  // prefix sums down the columns of the row window sums, of their moments along y and of the
+  // row window moments along x
+  std::array<double, PREFIX_SIZE> m_sums, m_momentsY, m_momentsX;
+};
+
+static_assert(TemplateSplat::isLinearFalloff(influence_templates::RESOURCE_PROXIMITY));
+static_assert(TemplateSplat::isLinearFalloff(influence_templates::AGENT_PROXIMITY));
+
+#endif
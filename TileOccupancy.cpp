@@ -0,0 +1,25 @@
+#include "TileOccupancy.h"
+
+#include <algorithm>
+
+void TileOccupancy::rebuild(const Map &map, const UnitStore &store, const std::vector<unithandle_t> &units)
+{
+  m_unitCounts.assign(map.getMapSize(), 0);
+  m_nonCityCounts.assign(map.getMapSize(), 0);
+  m_firstUnits.assign(map.getMapSize(), nullptr);
+
+  for (unithandle_t unit : units) {
+    tileindex_t tile = map.getTileIndex(store.getX(unit), store.getY(unit));
+    if (m_unitCounts[tile]++ == 0)
+      m_firstUnits[tile] = store.getBot(unit);
+    if (store.getType(unit) != UnitType::CITY)
+      m_nonCityCounts[tile]++;
+  }
+}
+
+void TileOccupancy::moveUnit(tileindex_t from, tileindex_t to)
+{
+  m_unitCounts[to]++;
+  if (m_unitCounts[from] > 0)
+    m_unitCounts[from]--;
+}
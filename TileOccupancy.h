@@ -0,0 +1,33 @@
+#ifndef TILE_OCCUPANCY_H
+#define TILE_OCCUPANCY_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Bot.h"
+#include "Map.h"
+#include "Types.h"
+#include "UnitStore.h"
+
+// Per-tile unit counts, rebuilt with the game state and kept up to date as moves are
+// issued during the turn so that pathfinding can test a tile in O(1).
+// The first unit of each tile follows the game state, not the moves issued.
+class TileOccupancy
+{
+public:
+  void rebuild(const Map &map, const UnitStore &store, const std::vector<unithandle_t> &units);
+  void moveUnit(tileindex_t from, tileindex_t to);
+
+  bool isOccupied(tileindex_t tile) const { return m_unitCounts[tile] != 0; }
+  uint16_t getUnitCount(tileindex_t tile) const { return m_unitCounts[tile]; }
+  // only workers and carts, not updated by moves
+  uint16_t getNonCityUnitCount(tileindex_t tile) const { return m_nonCityCounts[tile]; }
+  const Bot *getFirstUnit(tileindex_t tile) const { return m_firstUnits[tile]; }
+
+private:
+  std::vector<uint16_t> m_unitCounts;
+  std::vector<uint16_t> m_nonCityCounts;
+  std::vector<const Bot *> m_firstUnits;
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef TILE_SET_H
+#define TILE_SET_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+
+#include "GameRules.h"
+#include "InfluenceKernels.h"
+#include "Types.h"
+
+// Set of tiles of a map, one bit per tile in 16 words, enough for the largest maps.
+// This is the sparse form of path maps: a path covers a few dozen tiles, once they are found
+// (a single vectorized pass, see InfluenceMap::getPositiveTiles) coverage queries are popcounts
+// of 16 words instead of scans of whole maps. Tiles are visited in increasing order.
+class TileSet
+{
+public:
+  static constexpr size_t CAPACITY = game_rules::MAX_MAP_SIZE * game_rules::MAX_MAP_SIZE;
+  static constexpr size_t WORD_COUNT = CAPACITY / 64;
+
+  // tiles i with values[i] > 0
+  static TileSet positive(const float *values, size_t count)
+  {
+    if (count > CAPACITY)
+      throw std::runtime_error("Map too large for a tile set");
+    TileSet tiles;
+    influence_kernels::findPositive(values, count, tiles.m_words.data());
+    return tiles;
+  }
+
+  void insert(tileindex_t tile) { m_words[tile / 64] |= getBit(tile); }
+  void erase(tileindex_t tile) { m_words[tile / 64] &= ~getBit(tile); }
+  bool contains(tileindex_t tile) const { return m_words[tile / 64] & getBit(tile); }
+
+  bool empty() const
+  {
+    for (uint64_t word : m_words)
+      if (word) return false;
+    return true;
+  }
+
+  size_t size() const
+  {
+    size_t count = 0;
+    for (uint64_t word : m_words)
+      count += std::popcount(word);
+    return count;
+  }
+
+  // number of tiles in both sets
+  size_t countCommon(const TileSet &other) const
+  {
+    size_t count = 0;
+    for (size_t i = 0; i < WORD_COUNT; i++)
+      count += std::popcount(m_words[i] & other.m_words[i]);
+    return count;
+  }
+
+  // same as InfluenceMap::coversTiles, at least one tile must be covered
+  bool coversTiles(const TileSet &tilesToCover, int tilesNeeded) const
+  {
+    return countCommon(tilesToCover) >= static_cast<size_t>(std::max(tilesNeeded, 1));
+  }
+
+  // n-th tile in increasing order, n must be less than size()
+  tileindex_t getNth(size_t n) const
+  {
+    size_t i = 0;
+    for (size_t count; (count = std::popcount(m_words[i])) <= n; i++)
+      n -= count;
+    uint64_t word = m_words[i];
+    for (; n > 0; n--)
+      word &= word - 1;
+    return static_cast<tileindex_t>(i * 64 + std::countr_zero(word));
+  }
+
+  template <class Function>
+  void forEach(Function &&function) const
+  {
+    for (size_t i = 0; i < WORD_COUNT; i++) {
+      for (uint64_t word = m_words[i]; word; word &= word - 1)
+        function(static_cast<tileindex_t>(i * 64 + std::countr_zero(word)));
+    }
+  }
+
+  friend bool operator==(const TileSet &, const TileSet &) = default;
+
+private:
+  static uint64_t getBit(tileindex_t tile) { return uint64_t{ 1 } << (tile % 64); }
+
+  std::array<uint64_t, WORD_COUNT> m_words{};
+};
+
+#endif
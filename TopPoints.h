@@ -0,0 +1,107 @@
+#ifndef TOP_POINTS_H
+#define TOP_POINTS_H
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "InfluenceKernels.h"
+#include "Types.h"
+
+// Streaming selection of the n tiles with the highest values, behind getNHighestPoints.
+// Tiles are pushed in increasing order, the n best (value, tile) pairs are kept in a min-heap
+// and a tile below the lowest of them is skipped with a single compare. Runs of such tiles
+// are skipped with a vectorized search, once the heap is full few tiles get past it.
+// Ties go to the highest tile, like sorting the (value, tile) pairs in decreasing order.
+namespace top_points
+{
+
+// default mask, every tile can be selected
+struct AllTiles
+{
+  constexpr bool operator()(tileindex_t) const { return true; }
+};
+
+class TopPoints
+{
+public:
+  // heaps up to this size do not allocate
+  static constexpr int INLINE_CAPACITY = 64;
+
+  explicit TopPoints(int n)
+    : m_capacity(static_cast<size_t>(std::max(n, 0)))
+  {
+    if (m_capacity > INLINE_CAPACITY) {
+      m_overflow.resize(m_capacity);
+      m_heap = m_overflow.data();
+    } else {
+      m_heap = m_inline.data();
+    }
+    if (m_capacity == 0)
+      m_threshold = std::numeric_limits<float>::infinity();
+  }
+  TopPoints(const TopPoints &) = delete;
+  TopPoints &operator=(const TopPoints &) = delete;
+
+  // lowest value that can still be selected
+  float getThreshold() const { return m_threshold; }
+
+  void push(float value, tileindex_t tile)
+  {
+    if (value < m_threshold) return;
+    // the tile comes after every kept one, with the same value it still ranks higher
+    if (m_size == m_capacity) {
+      std::pop_heap(m_heap, m_heap + m_size, std::greater<>());
+      m_heap[m_size - 1] = { value, tile };
+    } else {
+      m_heap[m_size++] = { value, tile };
+    }
+    std::push_heap(m_heap, m_heap + m_size, std::greater<>());
+    if (m_size == m_capacity)
+      m_threshold = m_heap[0].first;
+  }
+
+  // pushes the 'count' consecutive tiles starting at firstTile, 'mask' is only asked about
+  // tiles above the threshold
+  template <class Mask = AllTiles>
+  void push(const float *values, tileindex_t firstTile, size_t count, const Mask &mask = {})
+  {
+    size_t i = influence_kernels::findAtLeast(values, count, m_threshold);
+    while (i < count) {
+      tileindex_t tile = static_cast<tileindex_t>(firstTile + i);
+      if (mask(tile))
+        push(values[i], tile);
+      i++;
+      i += influence_kernels::findAtLeast(values + i, count - i, m_threshold);
+    }
+  }
+
+  // the selected tiles by decreasing value, there are less than n if less were pushed
+  // the vector has room for n tiles
+  std::vector<tileindex_t> getPoints()
+  {
+    std::sort_heap(m_heap, m_heap + m_size, std::greater<>());
+    std::vector<tileindex_t> points;
+    points.reserve(m_capacity);
+    for (size_t i = 0; i < m_size; i++)
+      points.push_back(m_heap[i].second);
+    return points;
+  }
+
+private:
+  using Point = std::pair<float, tileindex_t>;
+
+  std::array<Point, INLINE_CAPACITY> m_inline;
+  std::vector<Point> m_overflow;
+  Point *m_heap;
+  size_t m_size = 0;
+  size_t m_capacity;
+  float m_threshold = -std::numeric_limits<float>::infinity();
+};
+
+}
+
+#endif
@@ -2,12 +2,13 @@
 
 #include "lux/annotate.hpp"
 #include "lux/kit.hpp"
+#include "UnitId.h"
 
 std::string TurnOrder::getAsString(const Map &map) const
 {
   switch (type) {
-  case TurnOrder::MOVE:          return kit::move(bot->getId(), map.getDirection(map.getTileIndex(*bot), targetTile));
-  case TurnOrder::BUILD_CITY:    return kit::buildCity(bot->getId());
+  case TurnOrder::MOVE:          return kit::move(unit_id::toString(bot->getId()), map.getDirection(map.getTileIndex(*bot), targetTile));
+  case TurnOrder::BUILD_CITY:    return kit::buildCity(unit_id::toString(bot->getId()));
   case TurnOrder::RESEARCH:      return kit::research(bot->getX(), bot->getY());
   case TurnOrder::DO_NOTHING:    return "";
   case TurnOrder::CREATE_WORKER: return kit::buildWorker(bot->getX(), bot->getY());
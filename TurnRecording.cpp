@@ -0,0 +1,209 @@
+#include "TurnRecording.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "lux/kit.hpp"
+
+namespace
+{
+
+constexpr size_t HEADER_SIZE = 4 + 4 * sizeof(uint32_t);
+constexpr size_t TURN_HEADER_SIZE = 2 * sizeof(uint32_t);
+constexpr size_t FOOTER_SIZE = sizeof(uint64_t) + sizeof(uint32_t) + 4;
+
+template<class T>
+void append(std::vector<char> &bytes, T value)
+{
+  // insert() of a char range trips GCC 12's -Warray-bounds/-Wstringop-overflow
+  size_t offset = bytes.size();
+  bytes.resize(offset + sizeof(T));
+  std::memcpy(bytes.data() + offset, &value, sizeof(T));
+}
+
+template<class T>
+T readAt(const char *data, size_t offset)
+{
+  T value;
+  std::memcpy(&value, data + offset, sizeof(T));
+  return value;
+}
+
+}
+
+bool TurnRecorder::open(const std::string &path, int playerId, int mapWidth, int mapHeight)
+{
+  close();
+  m_file = std::fopen(path.c_str(), "wb");
+  if (m_file == nullptr) return false;
+  // records are written in one call each, stdio buffering would only add a copy
+  std::setvbuf(m_file, nullptr, _IONBF, 0);
+
+  m_record.clear();
+  m_record.insert(m_record.end(), std::begin(turn_recording::HEADER_MAGIC), std::end(turn_recording::HEADER_MAGIC));
+  append(m_record, turn_recording::VERSION);
+  append(m_record, static_cast<uint32_t>(playerId));
+  append(m_record, static_cast<uint32_t>(mapWidth));
+  append(m_record, static_cast<uint32_t>(mapHeight));
+  write(m_record);
+  return true;
+}
+
+void TurnRecorder::recordTurn(std::string_view input, std::string_view orders)
+{
+  if (m_file == nullptr) return;
+  m_turnOffsets.push_back(m_fileSize);
+  m_record.clear();
+  append(m_record, static_cast<uint32_t>(input.size()));
+  append(m_record, static_cast<uint32_t>(orders.size()));
+  m_record.insert(m_record.end(), input.begin(), input.end());
+  m_record.insert(m_record.end(), orders.begin(), orders.end());
+  write(m_record);
+}
+
+void TurnRecorder::close()
+{
+  if (m_file == nullptr) return;
+  m_record.clear();
+  for (uint64_t offset : m_turnOffsets)
+    append(m_record, offset);
+  append(m_record, m_fileSize);
+  append(m_record, static_cast<uint32_t>(m_turnOffsets.size()));
+  m_record.insert(m_record.end(), std::begin(turn_recording::FOOTER_MAGIC), std::end(turn_recording::FOOTER_MAGIC));
+  write(m_record);
+  std::fclose(m_file);
+  m_file = nullptr;
+  m_fileSize = 0;
+  m_turnOffsets.clear();
+}
+
+void TurnRecorder::write(const std::vector<char> &bytes)
+{
+  m_fileSize += std::fwrite(bytes.data(), 1, bytes.size(), m_file);
+}
+
+bool TurnRecording::open(const std::string &path)
+{
+  close();
+#ifdef _WIN32
+  m_fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_fileHandle == INVALID_HANDLE_VALUE) {
+    m_fileHandle = nullptr;
+    return false;
+  }
+  LARGE_INTEGER fileSize;
+  GetFileSizeEx(m_fileHandle, &fileSize);
+  m_size = static_cast<size_t>(fileSize.QuadPart);
+  if (m_size > 0) {
+    m_mappingHandle = CreateFileMappingA(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mappingHandle != nullptr)
+      m_data = static_cast<const char *>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+  }
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) == 0)
+    m_size = static_cast<size_t>(fileStat.st_size);
+  if (m_size > 0) {
+    void *mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED)
+      m_data = static_cast<const char *>(mapping);
+  }
+  ::close(fd);
+#endif
+  if (m_data == nullptr || !isRecording({ m_data, m_size })) {
+    close();
+    return false;
+  }
+
+  m_playerId = static_cast<int>(readAt<uint32_t>(m_data, 8));
+  m_mapWidth = static_cast<int>(readAt<uint32_t>(m_data, 12));
+  m_mapHeight = static_cast<int>(readAt<uint32_t>(m_data, 16));
+  if (!readIndex())
+    rebuildIndex();
+  return true;
+}
+
+void TurnRecording::close()
+{
+#ifdef _WIN32
+  if (m_data != nullptr) UnmapViewOfFile(m_data);
+  if (m_mappingHandle != nullptr) CloseHandle(m_mappingHandle);
+  if (m_fileHandle != nullptr) CloseHandle(m_fileHandle);
+  m_mappingHandle = m_fileHandle = nullptr;
+#else
+  if (m_data != nullptr) munmap(const_cast<char *>(m_data), m_size);
+#endif
+  m_data = nullptr;
+  m_size = 0;
+  m_turnOffsets.clear();
+}
+
+bool TurnRecording::isRecording(std::string_view fileStart)
+{
+  return fileStart.size() >= HEADER_SIZE
+    && std::memcmp(fileStart.data(), turn_recording::HEADER_MAGIC, 4) == 0
+    && readAt<uint32_t>(fileStart.data(), 4) == turn_recording::VERSION;
+}
+
+std::string_view TurnRecording::getTurnInput(size_t turn) const
+{
+  uint64_t offset = m_turnOffsets[turn - 1];
+  return { m_data + offset + TURN_HEADER_SIZE, readAt<uint32_t>(m_data, offset) };
+}
+
+std::string_view TurnRecording::getTurnOrders(size_t turn) const
+{
+  uint64_t offset = m_turnOffsets[turn - 1];
+  uint32_t inputSize = readAt<uint32_t>(m_data, offset);
+  return { m_data + offset + TURN_HEADER_SIZE + inputSize, readAt<uint32_t>(m_data, offset + sizeof(uint32_t)) };
+}
+
+std::string TurnRecording::toTranscript(size_t firstTurn) const
+{
+  std::string transcript = std::to_string(m_playerId) + "\n" + std::to_string(m_mapWidth) + " " + std::to_string(m_mapHeight) + "\n";
+  for (size_t turn = firstTurn; turn <= getTurnCount(); turn++) {
+    std::string_view input = getTurnInput(turn);
+    transcript.append(input);
+    if (!input.empty()) transcript += '\n';
+    transcript += kit::INPUT_CONSTANTS::DONE;
+    transcript += '\n';
+  }
+  return transcript;
+}
+
+bool TurnRecording::readIndex()
+{
+  if (m_size < HEADER_SIZE + FOOTER_SIZE || std::memcmp(m_data + m_size - 4, turn_recording::FOOTER_MAGIC, 4) != 0)
+    return false;
+  uint64_t indexOffset = readAt<uint64_t>(m_data, m_size - FOOTER_SIZE);
+  uint32_t turnCount = readAt<uint32_t>(m_data, m_size - FOOTER_SIZE + sizeof(uint64_t));
+  if (indexOffset + turnCount * sizeof(uint64_t) + FOOTER_SIZE != m_size)
+    return false;
+  m_turnOffsets.resize(turnCount);
+  std::memcpy(m_turnOffsets.data(), m_data + indexOffset, turnCount * sizeof(uint64_t));
+  return true;
+}
+
+void TurnRecording::rebuildIndex()
+{
+  m_turnOffsets.clear();
+  size_t offset = HEADER_SIZE;
+  while (offset + TURN_HEADER_SIZE <= m_size) {
+    size_t recordSize = TURN_HEADER_SIZE + readAt<uint32_t>(m_data, offset) + readAt<uint32_t>(m_data, offset + sizeof(uint32_t));
+    if (offset + recordSize > m_size) break;
+    m_turnOffsets.push_back(offset);
+    offset += recordSize;
+  }
+}
@@ -0,0 +1,96 @@
+#ifndef TURN_RECORDING_H
+#define TURN_RECORDING_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Binary recording of a match as seen by the agent, written by main.cpp in record mode and
+// replayed by ReplayDriver. Layout (native endianness):
+//
+//   header : "LXRC", uint32 version, uint32 player id, uint32 map width, uint32 map height
+//   turn   : uint32 input size, uint32 orders size, raw turn input (without D_DONE), orders
+//   index  : uint64 file offset of each turn record
+//   footer : uint64 index offset, uint32 turn count, "LXRI"
+//
+// The index and footer are written when the recording is closed. A recording whose match
+// was interrupted has none, its index is rebuilt by walking the turn records.
+namespace turn_recording
+{
+
+static constexpr char HEADER_MAGIC[4] = { 'L', 'X', 'R', 'C' };
+static constexpr char FOOTER_MAGIC[4] = { 'L', 'X', 'R', 'I' };
+static constexpr uint32_t VERSION = 1;
+
+}
+
+// Appends one record per turn with a single unbuffered write, the record is built in a
+// buffer that is reused between turns.
+class TurnRecorder
+{
+public:
+  TurnRecorder() = default;
+  ~TurnRecorder() { close(); }
+  TurnRecorder(const TurnRecorder &) = delete;
+  TurnRecorder &operator=(const TurnRecorder &) = delete;
+
+  bool open(const std::string &path, int playerId, int mapWidth, int mapHeight);
+  void recordTurn(std::string_view input, std::string_view orders);
+  // writes the index, called by the destructor
+  void close();
+
+  bool isOpen() const { return m_file != nullptr; }
+
+private:
+  void write(const std::vector<char> &bytes);
+
+  std::FILE *m_file = nullptr;
+  uint64_t m_fileSize = 0;
+  std::vector<uint64_t> m_turnOffsets;
+  std::vector<char> m_record;
+};
+
+// Read-only view of a recording, the file is memory mapped so that any turn can be read
+// without touching the previous ones.
+class TurnRecording
+{
+public:
+  TurnRecording() = default;
+  ~TurnRecording() { close(); }
+  TurnRecording(const TurnRecording &) = delete;
+  TurnRecording &operator=(const TurnRecording &) = delete;
+
+  bool open(const std::string &path);
+  void close();
+
+  static bool isRecording(std::string_view fileStart);
+
+  int getPlayerId() const { return m_playerId; }
+  int getMapWidth() const { return m_mapWidth; }
+  int getMapHeight() const { return m_mapHeight; }
+  size_t getTurnCount() const { return m_turnOffsets.size(); }
+  // turns start at 1, views are valid until the recording is closed
+  std::string_view getTurnInput(size_t turn) const;
+  std::string_view getTurnOrders(size_t turn) const;
+
+  // rebuilds the text the agent read on stdin, starting at 'firstTurn'
+  std::string toTranscript(size_t firstTurn = 1) const;
+
+private:
+  bool readIndex();
+  void rebuildIndex();
+
+  const char *m_data = nullptr;
+  size_t m_size = 0;
+#ifdef _WIN32
+  void *m_fileHandle = nullptr;
+  void *m_mappingHandle = nullptr;
+#endif
+  int m_playerId = 0;
+  int m_mapWidth = 0, m_mapHeight = 0;
+  std::vector<uint64_t> m_turnOffsets;
+};
+
+#endif
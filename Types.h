@@ -5,6 +5,8 @@
 
 using tileindex_t = uint16_t;
 using player_t = uint8_t;
+using unitid_t = uint32_t; // see UnitId.h
+using unithandle_t = uint32_t; // see UnitStore.h
 
 struct Player
 {
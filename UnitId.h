@@ -0,0 +1,47 @@
+#ifndef UNIT_ID_H
+#define UNIT_ID_H
+
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "Types.h"
+
+// Units and cities are identified by compact integer handles instead of the strings
+// sent by lux-ai: "u_12" and "c_12" become 12, city tiles (which have no id) use their
+// tile index with CITY_TILE_FLAG set. The string form is only rebuilt to write orders.
+namespace unit_id
+{
+
+static constexpr unitid_t CITY_TILE_FLAG = 1u << 31;
+
+inline unitid_t fromString(std::string_view id)
+{
+  size_t separator = id.find('_');
+  unitid_t value{};
+  auto [ptr, ec] = std::from_chars(id.data() + separator + 1, id.data() + id.size(), value);
+  if (separator == std::string_view::npos || ec != std::errc{} || (value & CITY_TILE_FLAG))
+    throw std::runtime_error("Got unexpected unit id " + std::string(id));
+  return value;
+}
+
+inline unitid_t fromCityTile(tileindex_t tile)
+{
+  return CITY_TILE_FLAG | tile;
+}
+
+inline bool isCityTile(unitid_t id)
+{
+  return id & CITY_TILE_FLAG;
+}
+
+// units ids are given back as sent by lux-ai, city tiles ids are only used for logging
+inline std::string toString(unitid_t id)
+{
+  return isCityTile(id) ? "ct_" + std::to_string(id & ~CITY_TILE_FLAG) : "u_" + std::to_string(id);
+}
+
+}
+
+#endif
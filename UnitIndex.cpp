@@ -0,0 +1,38 @@
+#include "UnitIndex.h"
+
+#include <algorithm>
+
+void UnitIndex::rebuild(const UnitStore &store, const std::vector<unithandle_t> &units)
+{
+  // keep the load factor under 1/2 so that probe sequences stay short
+  size_t capacity = std::max<size_t>(m_entries.size(), 64);
+  while (capacity < units.size() * 2)
+    capacity *= 2;
+  m_entries.assign(capacity, Entry{});
+  m_mask = capacity - 1;
+
+  for (unithandle_t unit : units) {
+    unitid_t id = store.getId(unit);
+    size_t i = hash(id) & m_mask;
+    while (m_entries[i].unit != UnitStore::NO_HANDLE)
+      i = (i + 1) & m_mask;
+    m_entries[i] = { id, unit };
+  }
+}
+
+unithandle_t UnitIndex::find(unitid_t id) const
+{
+  if (m_entries.empty()) return UnitStore::NO_HANDLE;
+  for (size_t i = hash(id) & m_mask; m_entries[i].unit != UnitStore::NO_HANDLE; i = (i + 1) & m_mask) {
+    if (m_entries[i].id == id)
+      return m_entries[i].unit;
+  }
+  return UnitStore::NO_HANDLE;
+}
+
+size_t UnitIndex::hash(unitid_t id)
+{
+  // Fibonacci hashing, unit ids are consecutive and city tile ids share their high bit,
+  // keep the high bits of the product so that both spread over the table
+  return static_cast<size_t>((id * 11400714819323198485ull) >> 32);
+}
@@ -0,0 +1,33 @@
+#ifndef UNIT_INDEX_H
+#define UNIT_INDEX_H
+
+#include <vector>
+
+#include "Types.h"
+#include "UnitStore.h"
+
+// Maps unit ids to their handle in the unit store, used to match incoming units
+// with the units of the previous turn in O(1).
+// Open addressing with linear probing, the table is rebuilt once per turn and
+// keeps its capacity between turns.
+class UnitIndex
+{
+public:
+  // returns UnitStore::NO_HANDLE for unknown ids
+  void rebuild(const UnitStore &store, const std::vector<unithandle_t> &units);
+  unithandle_t find(unitid_t id) const;
+
+private:
+  struct Entry
+  {
+    unitid_t id = 0;
+    unithandle_t unit = UnitStore::NO_HANDLE; // empty entries have no unit
+  };
+
+  static size_t hash(unitid_t id);
+
+  std::vector<Entry> m_entries;
+  size_t m_mask = 0;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#include "UnitStore.h"
+
+#include "Bot.h"
+
+UnitStore::UnitStore() = default;
+UnitStore::~UnitStore() = default;
+
+unithandle_t UnitStore::create(unitid_t id, UnitType type, player_t team, const std::shared_ptr<BasicBehavior> &behaviorTree)
+{
+  unithandle_t unit;
+  if (!m_freeHandles.empty()) {
+    unit = m_freeHandles.back();
+    m_freeHandles.pop_back();
+  } else {
+    unit = static_cast<unithandle_t>(m_ids.size());
+    m_ids.emplace_back();
+    m_x.emplace_back();
+    m_y.emplace_back();
+    m_teams.emplace_back();
+    m_types.emplace_back();
+    m_cooldowns.emplace_back();
+    m_wood.emplace_back();
+    m_coal.emplace_back();
+    m_uranium.emplace_back();
+    m_bots.emplace_back();
+  }
+
+  m_ids[unit] = id;
+  m_x[unit] = m_y[unit] = 0;
+  m_teams[unit] = team;
+  m_types[unit] = type;
+  m_cooldowns[unit] = 0;
+  m_wood[unit] = m_coal[unit] = m_uranium[unit] = 0;
+  m_bots[unit] = std::make_unique<Bot>(*this, unit, behaviorTree);
+  return unit;
+}
+
+void UnitStore::release(unithandle_t unit)
+{
+  m_bots[unit].reset();
+  m_freeHandles.push_back(unit);
+}
@@ -0,0 +1,68 @@
+#ifndef UNIT_STORE_H
+#define UNIT_STORE_H
+
+#include <memory>
+#include <vector>
+
+#include "Types.h"
+
+class Bot;
+class BasicBehavior;
+
+enum class UnitType : uint8_t {
+  WORKER = 0,
+  CART,
+  CITY
+};
+
+// Owns every unit alive this turn. The fields read by the per-turn scans (position, team,
+// type, cooldown, cargo) are stored in parallel arrays indexed by the unit handle, the rest
+// of the unit (blackboard, behavior) lives in a separate pool of Bots.
+// Handles stay valid until the unit dies, released handles are reused by new units.
+class UnitStore
+{
+public:
+  static constexpr unithandle_t NO_HANDLE = static_cast<unithandle_t>(-1);
+
+  UnitStore();
+  ~UnitStore();
+  UnitStore(const UnitStore &) = delete;
+  UnitStore &operator=(const UnitStore &) = delete;
+
+  unithandle_t create(unitid_t id, UnitType type, player_t team, const std::shared_ptr<BasicBehavior> &behaviorTree);
+  void release(unithandle_t unit);
+
+  Bot *getBot(unithandle_t unit) const { return m_bots[unit].get(); }
+
+  unitid_t getId(unithandle_t unit) const { return m_ids[unit]; }
+  int getX(unithandle_t unit) const { return m_x[unit]; }
+  int getY(unithandle_t unit) const { return m_y[unit]; }
+  player_t getTeam(unithandle_t unit) const { return m_teams[unit]; }
+  UnitType getType(unithandle_t unit) const { return m_types[unit]; }
+  float getCooldown(unithandle_t unit) const { return m_cooldowns[unit]; }
+  int getWoodAmount(unithandle_t unit) const { return m_wood[unit]; }
+  int getCoalAmount(unithandle_t unit) const { return m_coal[unit]; }
+  int getUraniumAmount(unithandle_t unit) const { return m_uranium[unit]; }
+
+  void setPosition(unithandle_t unit, int x, int y) { m_x[unit] = static_cast<int16_t>(x); m_y[unit] = static_cast<int16_t>(y); }
+  void setCooldown(unithandle_t unit, float cooldown) { m_cooldowns[unit] = cooldown; }
+  void setCargo(unithandle_t unit, int wood, int coal, int uranium)
+  {
+    m_wood[unit] = static_cast<uint16_t>(wood);
+    m_coal[unit] = static_cast<uint16_t>(coal);
+    m_uranium[unit] = static_cast<uint16_t>(uranium);
+  }
+
+private:
+  std::vector<unitid_t> m_ids;
+  std::vector<int16_t>  m_x, m_y;
+  std::vector<player_t> m_teams;
+  std::vector<UnitType> m_types;
+  std::vector<float>    m_cooldowns;
+  std::vector<uint16_t> m_wood, m_coal, m_uranium;
+
+  std::vector<std::unique_ptr<Bot>> m_bots;
+  std::vector<unithandle_t> m_freeHandles;
+};
+
+#endif
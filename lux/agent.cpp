@@ -5,6 +5,7 @@
 #include "BehaviorTreeNodes.h"
 #include "Benchmarking.h"
 #include "AIParams.h"
+#include "UnitId.h"
 
 static const std::shared_ptr<BasicBehavior> BEHAVIOR_WORKER = std::make_shared<BasicBehavior>(nodes::behaviorWorker());
 static const std::shared_ptr<BasicBehavior> BEHAVIOR_CART = std::make_shared<BasicBehavior>(nodes::behaviorCart());
@@ -12,55 +13,68 @@ static const std::shared_ptr<BasicBehavior> BEHAVIOR_CITY = std::make_shared<Bas
 
 namespace kit
 {
-    void Agent::Initialize()
+    void Agent::Initialize(size_t firstTurn)
     {
-        mID = std::stoi(kit::getline());
-        std::string map_info = kit::getline();
-
-        std::vector<std::string> map_parts = kit::tokenize(map_info, " ");
-
-        m_mapWidth = stoi(map_parts[0]);
-        m_mapHeight = stoi(map_parts[1]);
-        m_gameState.map.setSize(m_mapWidth, m_mapHeight);
-        m_gameState.citiesInfluence.setSize(m_mapWidth, m_mapHeight);
-        m_gameState.resourcesInfluence.setSize(m_mapWidth, m_mapHeight);
+        mID = kit::parseInt(m_input->readLine());
+        std::string_view map_info = m_input->readLine();
+
+        std::array<std::string_view, kit::MAX_TOKENS> map_parts;
+        kit::tokenize(map_info, map_parts);
+
+        m_mapWidth = kit::parseInt(map_parts[0]);
+        m_mapHeight = kit::parseInt(map_parts[1]);
+        for (GameState &state : m_gameStates)
+            state.unitStore = &m_unitStore;
+        currentState().reset(m_mapWidth, m_mapHeight);
+        currentState().currentTurn = firstTurn - 1;
     }
 
     void Agent::ExtractGameState()
     {
-        GameState &oldState = m_gameState;
-        GameState newState;
-        GameStateDiff stateDiff;
+        ALLOCBENCHMARK_BEGIN(ExtractGameState);
+        GameState &oldState = m_gameStates[m_currentState];
+        GameState &newState = m_gameStates[1 - m_currentState];
+        GameStateDiff &stateDiff = m_gameStateDiff;
+        newState.reset(m_mapWidth, m_mapHeight);
+        // units that died last turn were only kept alive for the diff
+        for (Bot *deadBot : stateDiff.deadBots)
+            m_unitStore.release(deadBot->getHandle());
+        stateDiff.clear();
         newState.currentTurn = oldState.currentTurn + 1;
-        newState.map.setSize(m_mapWidth, m_mapHeight);
-        newState.citiesInfluence.setSize(m_mapWidth, m_mapHeight);
-        newState.resourcesInfluence.setSize(m_mapWidth, m_mapHeight);
-        newState.ennemyPath = std::move(oldState.ennemyPath);
+        newState.ennemyTrajectories.swap(oldState.ennemyTrajectories);
+
+        BENCHMARK_BEGIN(readTurn);
+        std::string_view turn = m_input->readTurn();
+        m_lastTurnInput = turn;
+        BENCHMARK_END(readTurn);
 
-        while (true)
+        BENCHMARK_BEGIN(parseTurn);
+        size_t lineCount = 0;
+        std::array<std::string_view, kit::MAX_TOKENS> updates;
+        while (!turn.empty())
         {
-            std::string updateInfo = kit::getline();
-            if (updateInfo == kit::INPUT_CONSTANTS::DONE)
-            {
-                break;
-            }
-            std::vector<std::string> updates = kit::tokenize(updateInfo, " ");
-            std::string input_identifier = updates[0];
+            std::string_view updateInfo = kit::popLine(turn);
+            lineCount++;
+            kit::tokenize(updateInfo, updates);
+            std::string_view input_identifier = updates[0];
             if (input_identifier == INPUT_CONSTANTS::RESEARCH_POINTS)
             {
-                int team = std::stoi(updates[1]);
-                int researchPoints = std::stoi(updates[2]);
+                int team = kit::parseInt(updates[1]);
+                int researchPoints = kit::parseInt(updates[2]);
                 newState.playerResearchPoints[getPlayer(team)] = researchPoints;
             }
             else if (input_identifier == INPUT_CONSTANTS::RESOURCES)
             {
                 kit::ResourceType resourceType = getResourceType(updates[1]);
-                int x = std::stoi(updates[2]);
-                int y = std::stoi(updates[3]);
-                int amt = std::stoi(updates[4]);
-                newState.map.tileAt(x, y).setResourceAmount(amt);
-                newState.map.tileAt(x, y).setType(TileType::RESOURCE, resourceType);
-                newState.resourcesIndex.push_back(newState.map.getTileIndex(x, y));
+                int x = kit::parseInt(updates[2]);
+                int y = kit::parseInt(updates[3]);
+                int amt = kit::parseInt(updates[4]);
+                tileindex_t tile = newState.map.getTileIndex(x, y);
+                newState.map.tileAt(tile).setResourceAmount(amt);
+                newState.map.tileAt(tile).setType(TileType::RESOURCE, resourceType);
+                newState.resourcesIndex.push_back(tile);
+                if (oldState.map.tileAt(tile).getResourceAmount() != amt)
+                    stateDiff.updatedResources.push_back(tile);
 
                 // here we don't care about our current research points because if a resource
                 // is not unlocked yet it is not a bad idea to continue expansion until it is.
@@ -77,97 +91,113 @@ namespace kit
             else if (input_identifier == INPUT_CONSTANTS::UNITS)
             {
                 int i = 1;
-                UnitType unitType = (UnitType)std::stoi(updates[i++]);
-                int team = std::stoi(updates[i++]);
-                std::string unitid = updates[i++];
-                int x = std::stoi(updates[i++]);
-                int y = std::stoi(updates[i++]);
-                float cooldown = std::stof(updates[i++]);
-                int wood = std::stoi(updates[i++]);
-                int coal = std::stoi(updates[i++]);
-                int uranium = std::stoi(updates[i++]);
-
-                auto existingAgent = std::ranges::find_if(oldState.bots,
-                  [&unitid](const std::unique_ptr<Bot> &agent) { return agent->getId() == unitid; });
-                if (existingAgent != oldState.bots.end()) {
-                  newState.bots.emplace_back(std::move(*existingAgent));
-                  oldState.bots.erase(existingAgent);
-                } else {
-                  newState.bots.push_back(std::make_unique<Bot>(unitid, unitType, getPlayer(team), unitType == UnitType::CART ? BEHAVIOR_CART : BEHAVIOR_WORKER));
-                  stateDiff.newBots.push_back(newState.bots.back().get());
+                UnitType unitType = (UnitType)kit::parseInt(updates[i++]);
+                int team = kit::parseInt(updates[i++]);
+                unitid_t unitid = unit_id::fromString(updates[i++]);
+                int x = kit::parseInt(updates[i++]);
+                int y = kit::parseInt(updates[i++]);
+                float cooldown = kit::parseFloat(updates[i++]);
+                int wood = kit::parseInt(updates[i++]);
+                int coal = kit::parseInt(updates[i++]);
+                int uranium = kit::parseInt(updates[i++]);
+
+                unithandle_t unit = m_unitIndex.find(unitid);
+                if (unit == UnitStore::NO_HANDLE) {
+                  unit = m_unitStore.create(unitid, unitType, getPlayer(team), unitType == UnitType::CART ? BEHAVIOR_CART : BEHAVIOR_WORKER);
+                  stateDiff.newBots.push_back(m_unitStore.getBot(unit));
+                } else if (m_unitStore.getX(unit) != x || m_unitStore.getY(unit) != y) {
+                  // the store still holds the previous turn's position
+                  tileindex_t from = newState.map.getTileIndex(m_unitStore.getX(unit), m_unitStore.getY(unit));
+                  stateDiff.movedBots.push_back({ m_unitStore.getBot(unit), from, newState.map.getTileIndex(x, y) });
                 }
+                newState.units.push_back(unit);
 
                 if (getPlayer(team) == Player::ENEMY) {
-                  if (newState.ennemyPath.contains(unitid))
-                    newState.ennemyPath[unitid].addMap(newState.ennemyPath[unitid], -1.0f/params::ennemyPathingTurn);
-                  else 
-                    newState.ennemyPath.insert({ unitid, InfluenceMap{ m_mapWidth, m_mapHeight } });
-                  newState.ennemyPath[unitid].addValueAtIndex(newState.map.getTileIndex(x, y), 1.0f);
+                  EnemyTrajectory &trajectory = newState.ennemyTrajectories[unitid];
+                  trajectory.add(newState.currentTurn, newState.map.getTileIndex(x, y));
+                  trajectory.updateHeading(m_mapWidth, static_cast<size_t>(params::pathStep));
                 }
 
-                std::unique_ptr<Bot> &updatedAgent = newState.bots.back();
-                updatedAgent->setX(x);
-                updatedAgent->setY(y);
-                updatedAgent->setCooldown(cooldown);
-                updatedAgent->setWoodAmount(wood);
-                updatedAgent->setCoalAmount(coal);
-                updatedAgent->setUraniumAmount(uranium);
+                m_unitStore.setPosition(unit, x, y);
+                m_unitStore.setCooldown(unit, cooldown);
+                m_unitStore.setCargo(unit, wood, coal, uranium);
             }
             else if (input_identifier == INPUT_CONSTANTS::CITY)
             {
                 int i = 1;
-                int team = std::stoi(updates[i++]);
-                std::string cityid = updates[i++];
-                float fuel = std::stof(updates[i++]);
-                float lightUpkeep = std::stof(updates[i++]);
-                newState.cities.push_back(std::make_unique<City>(cityid, getPlayer(team), fuel, lightUpkeep));
+                int team = kit::parseInt(updates[i++]);
+                unitid_t cityid = unit_id::fromString(updates[i++]);
+                float fuel = kit::parseFloat(updates[i++]);
+                float lightUpkeep = kit::parseFloat(updates[i++]);
+                newState.cities.emplace_back(cityid, getPlayer(team), fuel, lightUpkeep);
             }
             else if (input_identifier == INPUT_CONSTANTS::CITY_TILES)
             {
                 int i = 1;
-                int team = std::stoi(updates[i++]);
-                std::string cityid = updates[i++];
-                int x = std::stoi(updates[i++]);
-                int y = std::stoi(updates[i++]);
-                float cooldown = std::stof(updates[i++]);
+                int team = kit::parseInt(updates[i++]);
+                i++; // city id, city tiles are matched by position
+                int x = kit::parseInt(updates[i++]);
+                int y = kit::parseInt(updates[i++]);
+                float cooldown = kit::parseFloat(updates[i++]);
 
                 // lux-ai does not provide ids for city units by default
-                std::string unitid = "c_" + std::to_string(x) + "_" + std::to_string(y);
+                unitid_t unitid = unit_id::fromCityTile(newState.map.getTileIndex(x, y));
                 
-                auto existingAgent = std::ranges::find_if(oldState.bots,
-                  [&unitid](const std::unique_ptr<Bot> &agent) { return agent->getId() == unitid; });
-                if (existingAgent != oldState.bots.end()) {
-                  newState.bots.emplace_back(std::move(*existingAgent));
-                  oldState.bots.erase(existingAgent);
-                } else {
-                  newState.bots.push_back(std::make_unique<Bot>(unitid, UnitType::CITY, getPlayer(team), BEHAVIOR_CITY));
-                  stateDiff.newBots.push_back(newState.bots.back().get());
+                unithandle_t unit = m_unitIndex.find(unitid);
+                if (unit == UnitStore::NO_HANDLE) {
+                  unit = m_unitStore.create(unitid, UnitType::CITY, getPlayer(team), BEHAVIOR_CITY);
+                  stateDiff.newBots.push_back(m_unitStore.getBot(unit));
+                  stateDiff.newCityTiles[getPlayer(team)].push_back(newState.map.getTileIndex(x, y));
                 }
-                std::unique_ptr<Bot> &updatedAgent = newState.bots.back();
-                updatedAgent->setX(x);
-                updatedAgent->setY(y);
-                updatedAgent->setCooldown(cooldown);
-                newState.citiesBot.push_back(updatedAgent.get());
+                newState.units.push_back(unit);
+                m_unitStore.setPosition(unit, x, y);
+                m_unitStore.setCooldown(unit, cooldown);
+                newState.citiesBot.push_back(m_unitStore.getBot(unit));
                 newState.map.tileAt(x, y).setType(getPlayer(team) == Player::ALLY ? TileType::ALLY_CITY : TileType::ENEMY_CITY);
             }
             else if (input_identifier == INPUT_CONSTANTS::ROADS)
             {
                 int i = 1;
-                int x = std::stoi(updates[i++]);
-                int y = std::stoi(updates[i++]);
-                float road = std::stof(updates[i++]);
+                int x = kit::parseInt(updates[i++]);
+                int y = kit::parseInt(updates[i++]);
+                float road = kit::parseFloat(updates[i++]);
                 tileindex_t tile = oldState.map.getTileIndex(x, y);
                 newState.map.tileAt(tile).setRoadAmount(road);
                 if (oldState.map.tileAt(tile).getRoadAmount() != road)
                     stateDiff.updatedRoads.push_back(tile);
             }
         }
-
-        stateDiff.deadBots = std::move(oldState.bots);
+        BENCHMARK_END_AVERAGE(parseTurn, lineCount, "line");
+
+        // units of the previous turn that were not received this turn died
+        m_unitIndex.rebuild(m_unitStore, newState.units);
+        for (unithandle_t unit : oldState.units) {
+            if (m_unitIndex.find(m_unitStore.getId(unit)) != UnitStore::NO_HANDLE)
+                continue;
+            stateDiff.deadBots.push_back(m_unitStore.getBot(unit));
+            if (m_unitStore.getType(unit) == UnitType::CITY)
+                stateDiff.lostCityTiles[m_unitStore.getTeam(unit)].push_back(newState.map.getTileIndex(m_unitStore.getX(unit), m_unitStore.getY(unit)));
+        }
+        // depleted resources are not sent anymore
+        for (tileindex_t tile : oldState.resourcesIndex) {
+            if (newState.map.tileAt(tile).getType() != TileType::RESOURCE)
+                stateDiff.depletedResources.push_back(tile);
+        }
+        for (player_t team = 0; team < Player::COUNT; team++) {
+            auto crossed = [&](size_t threshold) { return oldState.playerResearchPoints[team] < threshold && newState.playerResearchPoints[team] >= threshold; };
+            if (crossed(game_rules::MIN_RESEARCH_COAL))
+                stateDiff.unlockedResources[team].push_back(kit::ResourceType::coal);
+            if (crossed(game_rules::MIN_RESEARCH_URANIUM))
+                stateDiff.unlockedResources[team].push_back(kit::ResourceType::uranium);
+        }
+        newState.occupancy.rebuild(newState.map, m_unitStore, newState.units);
+#ifdef BENCHMARKING
+        benchmark::logs << newState.units.size() << " bots extracted\n";
+#endif
 
         newState.map.rebuildResourceAdjencies();
-        m_gameState = std::move(newState);
-        m_gameStateDiff = std::move(stateDiff);
+        m_currentState = 1 - m_currentState;
+        ALLOCBENCHMARK_END(ExtractGameState);
     }
 
     void Agent::GetTurnOrders(std::vector<std::string>& orders)
@@ -176,17 +206,17 @@ namespace kit
         // (already done by ExtractGameState)
         // think
         BENCHMARK_BEGIN(computeInfluence);
-        m_gameState.computeInfluence(m_gameStateDiff);
+        currentState().computeInfluence(m_gameStateDiff);
         BENCHMARK_END(computeInfluence);
         BENCHMARK_BEGIN(updateHighLevelObjectives);
-        m_commander.updateHighLevelObjectives(&m_gameState, m_gameStateDiff);
+        m_commander.updateHighLevelObjectives(&currentState(), m_gameStateDiff);
         BENCHMARK_END(updateHighLevelObjectives);
         // act
         BENCHMARK_BEGIN(getTurnOrders);
         std::vector<TurnOrder> commanderOrders = m_commander.getTurnOrders(m_gameStateDiff);
         BENCHMARK_END(getTurnOrders);
         auto ordersEnd = std::ranges::remove_if(commanderOrders, [](TurnOrder &t) { return t.type == TurnOrder::DO_NOTHING; }).begin();
-        std::transform(commanderOrders.begin(), ordersEnd, std::back_inserter(orders), [&](TurnOrder &o) { return o.getAsString(m_gameState.map); });
+        std::transform(commanderOrders.begin(), ordersEnd, std::back_inserter(orders), [&](TurnOrder &o) { return o.getAsString(currentState().map); });
     }
 
     player_t Agent::getPlayer(int teamId)
@@ -194,12 +224,12 @@ namespace kit
         return teamId == mID ? Player::ALLY : Player::ENEMY;
     }
 
-    kit::ResourceType Agent::getResourceType(const std::string &name)
+    kit::ResourceType Agent::getResourceType(std::string_view name)
     {
         if(name == "wood") return kit::ResourceType::wood;
         else if(name == "coal") return kit::ResourceType::coal;
         else if(name == "uranium") return kit::ResourceType::uranium;
-        throw std::runtime_error("Got unexpected resource name " + name);
+        throw std::runtime_error("Got unexpected resource name " + std::string(name));
     }
 }
 
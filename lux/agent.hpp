@@ -3,27 +3,45 @@
 
 #include "lux/kit.hpp"
 #include "CommandChain.h"
+#include "UnitIndex.h"
 
 namespace kit
 {
     class Agent
     {
     public:
-        void Initialize();
+        explicit Agent(InputReader &input = stdinReader()) : m_input(&input) {}
+
+        // 'firstTurn' is the turn of the first ExtractGameState, for inputs that start mid-game
+        void Initialize(size_t firstTurn = 1);
         void ExtractGameState();
         void GetTurnOrders(std::vector<std::string>& orders);
 
         int getId() const { return mID; }
+        int getMapWidth() const { return m_mapWidth; }
+        int getMapHeight() const { return m_mapHeight; }
+        const GameState &getGameState() const { return m_gameStates[m_currentState]; }
+        const GameStateDiff &getGameStateDiff() const { return m_gameStateDiff; }
+        // raw input of the last extracted turn (without D_DONE), valid until the next turn is read
+        std::string_view getLastTurnInput() const { return m_lastTurnInput; }
 
     private:
         player_t getPlayer(int teamId);
-        static kit::ResourceType getResourceType(const std::string &name);
+        GameState &currentState() { return m_gameStates[m_currentState]; }
+        static kit::ResourceType getResourceType(std::string_view name);
 
     private:
+        InputReader *m_input;
+        std::string_view m_lastTurnInput;
         int mID = 0;
         int m_mapWidth{}, m_mapHeight{};
-        GameState m_gameState{}; // current game state
+        // the game state is double buffered, each turn the previous state is reset in place
+        // and filled with the new turn so that its buffers are reused
+        std::array<GameState, 2> m_gameStates{};
+        size_t m_currentState = 0;
         GameStateDiff m_gameStateDiff; // game state changes since previous turn
+        UnitStore m_unitStore; // units of both game states
+        UnitIndex m_unitIndex; // units of the current game state by id
         Commander m_commander;
     };
 }
@@ -1,11 +1,22 @@
 #ifndef kit_h
 #define kit_h
 
+#include <array>
+#include <charconv>
+#include <cstring>
 #include <ostream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <vector>
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 namespace kit
 {
     enum class ResourceType : char
@@ -36,40 +47,154 @@ namespace kit
         CENTER = 'c'
     };
 
-    static std::string getline()
+    // maximum number of space separated tokens in an input line ('u' lines are the longest)
+    static constexpr size_t MAX_TOKENS = 10;
+
+    /**
+     * Reads a file descriptor in large blocks and hands out lines as views into its buffer.
+     * Unread bytes slide back to the front of the buffer before each block is read (instead
+     * of wrapping around) so that a line, or a full turn, is always contiguous. The buffer
+     * grows when a single turn does not fit. Reaching the end of the input exits the program.
+     * A reader can also be built over an in-memory transcript (see ReplayDriver), reading past
+     * its end throws instead.
+     */
+    class InputReader
     {
-        // exit if stdin is bad now
-        if (!std::cin.good())
-            exit(0);
+    public:
+        explicit InputReader(int fd, size_t blockSize = 1 << 16) : m_fd(fd), m_buffer(blockSize) {}
+        explicit InputReader(std::string_view transcript)
+            : m_fd(-1), m_buffer(transcript.begin(), transcript.end()), m_end(transcript.size())
+        {
+            if (m_buffer.empty() || m_buffer.back() != '\n')
+            {
+                m_buffer.push_back('\n');
+                m_end++;
+            }
+        }
 
-        char str[2048], ch;
-        int i = 0;
-        ch = getchar();
-        while (ch != '\n')
+        /** returns the next line without its line feed, the view is valid until the next read */
+        std::string_view readLine()
         {
-            str[i] = ch;
-            i++;
-            ch = std::getchar();
+            size_t lineEnd = findLineEnd(0);
+            std::string_view line{ m_buffer.data() + m_begin, lineEnd };
+            m_begin += lineEnd + 1;
+            return line;
+        }
+
+        /** returns every line up to (excluding) D_DONE as one view, valid until the next read */
+        std::string_view readTurn()
+        {
+            // offsets are relative to m_begin, which moves when a block is read
+            size_t lineStart = 0;
+            while (true)
+            {
+                size_t lineEnd = findLineEnd(lineStart);
+                if (std::string_view(m_buffer.data() + m_begin + lineStart, lineEnd - lineStart) == INPUT_CONSTANTS::DONE)
+                {
+                    std::string_view turn{ m_buffer.data() + m_begin, lineStart == 0 ? 0 : lineStart - 1 };
+                    m_begin += lineEnd + 1;
+                    return turn;
+                }
+                lineStart = lineEnd + 1;
+            }
+        }
+
+    private:
+        // offset (relative to m_begin) of the first line feed at or after 'from'
+        size_t findLineEnd(size_t from)
+        {
+            while (true)
+            {
+                const char *unread = m_buffer.data() + m_begin;
+                const void *lineFeed = std::memchr(unread + from, '\n', m_end - m_begin - from);
+                if (lineFeed != nullptr)
+                    return static_cast<const char *>(lineFeed) - unread;
+                from = m_end - m_begin;
+                readBlock();
+            }
+        }
+
+        void readBlock()
+        {
+            if (m_fd < 0)
+                throw std::runtime_error("Reached the end of the transcript");
+            if (m_begin > 0)
+            {
+                std::memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+                m_end -= m_begin;
+                m_begin = 0;
+            }
+            if (m_end == m_buffer.size())
+                m_buffer.resize(m_buffer.size() * 2);
+
+#ifdef _WIN32
+            int readCount = _read(m_fd, m_buffer.data() + m_end, static_cast<unsigned int>(m_buffer.size() - m_end));
+#else
+            ssize_t readCount = ::read(m_fd, m_buffer.data() + m_end, m_buffer.size() - m_end);
+#endif
+            // exit if stdin is bad now
+            if (readCount <= 0)
+                exit(0);
+            m_end += readCount;
         }
 
-        str[i] = '\0';
-        // return the line
-        return std::string(str);
+    private:
+        int m_fd;
+        std::vector<char> m_buffer;
+        size_t m_begin = 0, m_end = 0; // unread bytes are [m_begin, m_end)
+    };
+
+    inline InputReader &stdinReader()
+    {
+        static InputReader reader{ 0 };
+        return reader;
     }
 
-    static std::vector<std::string> tokenize(std::string s, std::string del = " ")
+    static std::string getline()
     {
-        std::vector<std::string> strings = std::vector<std::string>();
-        std::size_t start = 0;
-        std::size_t end = s.find(del);
-        while (end != -1)
+        return std::string(stdinReader().readLine());
+    }
+
+    /** removes the first line from text and returns it (without its line feed) */
+    static std::string_view popLine(std::string_view &text)
+    {
+        size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        return line;
+    }
+
+    /** splits line on spaces, the returned views point into line. Returns the number of tokens found */
+    static size_t tokenize(std::string_view line, std::array<std::string_view, MAX_TOKENS> &tokens)
+    {
+        size_t count = 0;
+        while (count < MAX_TOKENS)
         {
-            strings.push_back(s.substr(start, end - start));
-            start = end + del.size();
-            end = s.find(del, start);
+            size_t end = line.find(' ');
+            tokens[count++] = line.substr(0, end);
+            if (end == std::string_view::npos)
+                break;
+            line.remove_prefix(end + 1);
         }
-        strings.push_back(s.substr(start, end - start));
-        return strings;
+        return count;
+    }
+
+    static int parseInt(std::string_view token)
+    {
+        int value{};
+        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (ec != std::errc{})
+            throw std::runtime_error("Got unexpected integer " + std::string(token));
+        return value;
+    }
+
+    static float parseFloat(std::string_view token)
+    {
+        float value{};
+        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (ec != std::errc{})
+            throw std::runtime_error("Got unexpected number " + std::string(token));
+        return value;
     }
 
     /** return the command to move unit in the given direction */
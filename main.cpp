@@ -11,8 +11,9 @@
 #include "Log.h"
 #include "lux/annotate.hpp"
 #include "Statistics.h"
+#include "TurnRecording.h"
 
-int main()
+int main(int argc, char **argv)
 {
     if (params::trainingMode)
         params::updateParams();
@@ -27,7 +28,16 @@ int main()
     kit::Agent agent = kit::Agent();
     agent.Initialize();
 
+    // "--record <file>" writes every turn's input and orders to a binary file, see TurnRecording.h
+    // static so that the index is still written when the input ends (kit::InputReader exits)
+    static TurnRecorder recorder;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--record" && !recorder.open(argv[i + 1], agent.getId(), agent.getMapWidth(), agent.getMapHeight()))
+            std::cerr << "Could not open " << argv[i + 1] << " for recording" << std::endl;
+    }
+
     int currentTurn = 0;
+    std::string ordersLine;
 
     #ifdef BENCHMARKING
     std::string benchmarkFile = "..\\..\\benchmark" + std::to_string(agent.getId()) + ".txt";
@@ -52,6 +62,7 @@ int main()
             MULTIBENCHMARK_BEGIN(getBestCityBuildingLocation);
             MULTIBENCHMARK_BEGIN(getBestCityFeedingLocation);
             MULTIBENCHMARK_BEGIN(propagateAllTimes);
+            MULTIBENCHMARK_BEGIN(unitScans);
 
             BENCHMARK_BEGIN(ExtractGameState);
             agent.ExtractGameState();
@@ -62,20 +73,24 @@ int main()
             if(currentTurn < playedTurns) agent.GetTurnOrders(orders);
 
             //Send orders to game engine
+            ordersLine.clear();
             for (int i = 0; i < orders.size(); i++) {
                 if (i != 0)
-                    std::cout << ",";
-                std::cout << orders[i];
+                    ordersLine += ',';
+                ordersLine += orders[i];
             }
-            std::cout << std::endl;
+            std::cout << ordersLine << std::endl;
             
             // end turn
             kit::end_turn();
+            // after the orders reached the engine, recording must not delay them
+            recorder.recordTurn(agent.getLastTurnInput(), ordersLine);
             MULTIBENCHMARK_END(AgentBT);
             MULTIBENCHMARK_END(Astar);
             MULTIBENCHMARK_END(getBestCityBuildingLocation);
             MULTIBENCHMARK_END(getBestCityFeedingLocation);
             MULTIBENCHMARK_END(propagateAllTimes);
+            MULTIBENCHMARK_END(unitScans);
             BENCHMARK_END(TurnTotal);
 
             #ifdef BENCHMARKING